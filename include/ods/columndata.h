@@ -0,0 +1,103 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ods/iattribute.h"
+#include "ods/icolumn.h"
+#include "ods/odsdef.h"
+
+namespace ods {
+
+/** \brief Defines how the column values are stored in a ColumnData object. */
+enum class ColumnStorage : uint8_t {
+  Integer = 0, ///< 64-bit integers. Also used for booleans and enumerates.
+  Float = 1, ///< Double values.
+  Text = 2, ///< UTF8 strings. Also used for dates.
+  Bytes = 3 ///< Byte arrays (BLOB).
+};
+
+[[nodiscard]] ColumnStorage DataTypeToStorage(DataType type);
+
+/** \brief Column-major storage of the values of one column.
+ *
+ * The class holds all values of a column in one typed vector instead of
+ * one attribute per row, which is what an IItem list does. This is much
+ * cheaper when only a few columns are read from a large table.
+ *
+ * Integer and float values are stored in plain vectors. Text and byte array
+ * values are stored in one byte buffer with an offset list, where the value
+ * of row N is the bytes between offset N and N + 1. A null value is
+ * marked in the null bitmap, and is stored as 0 or as an empty value.
+ */
+class ColumnData final {
+ public:
+  ColumnData() = default;
+  explicit ColumnData(const IColumn& column);
+
+  [[nodiscard]] const std::string& Name() const { return name_; }
+  [[nodiscard]] const std::string& BaseName() const { return base_name_; }
+  [[nodiscard]] ods::DataType DataType() const { return data_type_; }
+  [[nodiscard]] ColumnStorage Storage() const { return storage_; }
+
+  /** \brief Returns number of rows. */
+  [[nodiscard]] size_t Size() const { return nof_rows_; }
+  [[nodiscard]] bool IsNull(size_t row) const;
+  [[nodiscard]] size_t NofNulls() const;
+
+  /** \brief Integer values. Only used by integer columns. */
+  [[nodiscard]] const std::vector<int64_t>& Integers() const {
+    return integer_list_;
+  }
+  /** \brief Float values. Only used by float columns. */
+  [[nodiscard]] const std::vector<double>& Floats() const {
+    return float_list_;
+  }
+  /** \brief Text value of a text column. */
+  [[nodiscard]] std::string_view Text(size_t row) const;
+  /** \brief Byte array value of a text or byte array column. */
+  [[nodiscard]] std::span<const uint8_t> Bytes(size_t row) const;
+
+  /** \brief Null bitmap. Bit N (LSB first) is set if row N is null. */
+  [[nodiscard]] const std::vector<uint8_t>& NullBitmap() const {
+    return null_bitmap_;
+  }
+
+  void Reserve(size_t nof_rows);
+  void Clear();
+
+  void AppendNull();
+  void AppendInteger(int64_t value);
+  void AppendFloat(double value);
+  /** \brief Appends a text or byte array value. */
+  void AppendBytes(const void* data, size_t nof_bytes);
+  /** \brief Appends an attribute value. A null attribute is a null value. */
+  void AppendAttribute(const IAttribute* attribute);
+
+ private:
+  std::string name_; ///< Application name.
+  std::string base_name_;
+  ods::DataType data_type_ = DataType::DtUnknown;
+  ColumnStorage storage_ = ColumnStorage::Text;
+
+  size_t nof_rows_ = 0;
+  std::vector<uint8_t> null_bitmap_;
+  std::vector<int64_t> integer_list_;
+  std::vector<double> float_list_;
+  std::vector<size_t> offset_list_ = {0}; ///< Text and byte array offsets.
+  std::vector<uint8_t> byte_list_; ///< Text and byte array values.
+
+  void AppendRow(bool null);
+};
+
+/** \brief Columns in the requested column order. */
+using ColumnDataList = std::vector<ColumnData>;
+
+}  // namespace ods
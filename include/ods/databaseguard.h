@@ -7,6 +7,13 @@
 
 namespace ods {
 
+/** \brief Scope guard that opens the database and ends its transaction.
+ *
+ * The guard opens a closed database and closes it (commit) when the guard
+ * goes out of scope. If the database is in persistent mode, the connection
+ * is kept open and the guard only begins and commits a transaction. A guard
+ * on an already open database, with an active transaction, does nothing.
+ */
 class DatabaseGuard final {
  public:
 
@@ -6,7 +6,9 @@
 #include <string>
 #include <sstream>
 #include <typeinfo>
+#include <type_traits>
 #include <utility>
+#include <variant>
 #include <vector>
 
 #pragma once
@@ -16,9 +18,12 @@ namespace ods {
 /** \brief Generic class for a column value in a database
  *
  * The class is used to represent a column value in a generic way.
- * The internal storage is a string. The interpretation of the string
- * so the different data types are stored as below. Note that the
- * std::locale("C") is used when formatting integers and float values.
+ * The value is stored in its own type (integer, float, boolean, string or
+ * byte array), so typed values are set and read without any text
+ * conversion. The value is only converted to a string when a string is
+ * requested. The string representation of the different data types are
+ * as below. Note that the std::locale("C") is used when formatting integers
+ * and float values.
  * <ul>
  * <li> DtString: As an UTF8 coded string.
  * <li> DtExternalRef: As an UTF8 coded string.
@@ -40,7 +45,20 @@ class IAttribute {
  private:
   std::string name_; ///< Application Name (Required)
   std::string base_name_; ///< Base name of the column (Optional but recommended)
-  std::string value_; ///< Note that BLOB are stored as Base64 strings
+  /** \brief Typed value storage.
+   *
+   * Signed integers are stored as int64_t and unsigned integers (for example
+   * DtDate nanoseconds since 1970) as uint64_t.
+   */
+  using AttributeValue = std::variant<std::string, int64_t, uint64_t, double,
+                                      float, bool, std::vector<uint8_t>>;
+  AttributeValue value_;
+
+  /** \brief Returns the value as a string.
+   *
+   * Note that BLOB values are returned as Base64 strings.
+   */
+  [[nodiscard]] std::string Text() const;
 
  public:
 
@@ -86,15 +104,36 @@ class IAttribute {
    * @return True if the value is empty.
    */
   [[nodiscard]] bool IsValueEmpty() const { ///< Returns true if the value is an empty string
-    return value_.empty();
+    if (const auto* text = std::get_if<std::string>(&value_)) {
+      return text->empty();
+    }
+    if (const auto* bytes = std::get_if<std::vector<uint8_t>>(&value_)) {
+      return bytes->empty();
+    }
+    return false;
   }
 
   template <typename T>
   [[nodiscard]] T Value() const {
+    if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool> &&
+        sizeof(T) > 1) {
+      // Integers are returned without any text parsing if they fit.
+      if (const auto* number = std::get_if<int64_t>(&value_);
+          number != nullptr && std::in_range<T>(*number)) {
+        return static_cast<T>(*number);
+      }
+      if (const auto* number = std::get_if<uint64_t>(&value_);
+          number != nullptr && std::in_range<T>(*number)) {
+        return static_cast<T>(*number);
+      }
+      if (const auto* flag = std::get_if<bool>(&value_)) {
+        return static_cast<T>(*flag ? 1 : 0);
+      }
+    }
     T val {};
 
     try {
-      std::istringstream temp(value_);
+      std::istringstream temp(Text());
       temp >> val;
     } catch (const std::exception& ) {
     }
@@ -103,10 +142,16 @@ class IAttribute {
 
   template <typename T>
   void Value(T value) {
-    try {
-       value_ = std::to_string(value);
-    } catch (const std::exception& ) {
-      value_ = {};
+    if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+      value_ = static_cast<int64_t>(value);
+    } else if constexpr (std::is_integral_v<T>) {
+      value_ = static_cast<uint64_t>(value);
+    } else {
+      try {
+        value_ = std::to_string(value);
+      } catch (const std::exception& ) {
+        value_ = std::string();
+      }
     }
   }
 
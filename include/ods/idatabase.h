@@ -3,10 +3,14 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <chrono>
 #include <string>
 #include <functional>
 #include <map>
+#include <span>
+#include <vector>
 
+#include "ods/columndata.h"
 #include "ods/itable.h"
 #include "ods/iitem.h"
 #include "ods/sqlfilter.h"
@@ -14,6 +18,8 @@
 
 namespace ods {
 
+class TableLayout;
+
 enum class DbType : uint8_t {
   TypeGeneric = 0,
   TypeSqlite = 1,
@@ -48,6 +54,49 @@ class IDatabase {
   virtual bool Close(bool commit) = 0;
   [[nodiscard]] virtual bool IsOpen() const = 0;
 
+  /** \brief Keeps the connection open between database guards.
+   *
+   * By default, the DatabaseGuard opens the database and closes it when the
+   * guard goes out of scope. In persistent mode, the guard only begins and
+   * commits a transaction, so the connection and its caches are kept
+   * between the guards. The application should close the database when it
+   * is not needed anymore.
+   * @param persistent Set to true to keep the connection open.
+   */
+  void Persistent(bool persistent) { persistent_ = persistent; }
+  [[nodiscard]] bool Persistent() const { return persistent_; }
+
+  /** \brief Begins a transaction on an open database. */
+  virtual void BeginTransaction();
+  /** \brief Commits the current transaction but keeps the database open. */
+  virtual void CommitTransaction();
+  /** \brief Rollbacks the current transaction but keeps the database open. */
+  virtual void RollbackTransaction();
+  /** \brief Returns true if a transaction is active. */
+  [[nodiscard]] virtual bool InTransaction() const;
+
+  /** \brief Max execution time of each query.
+   *
+   * A query that runs longer than the timeout is aborted and the function
+   * that runs it throws an exception. This gives interactive tools a bounded
+   * latency on slow queries. A zero timeout means no timeout, which is the
+   * default.
+   * @param timeout Max execution time.
+   */
+  virtual void QueryTimeout(std::chrono::milliseconds timeout);
+  [[nodiscard]] std::chrono::milliseconds QueryTimeout() const {
+    return query_timeout_;
+  }
+
+  /** \brief Aborts the running query.
+   *
+   * The function is thread-safe and is typically called from another thread,
+   * for example by a cancel button. The aborted function throws an
+   * exception. The call is ignored if no query is running. By default,
+   * this function doesn't do anything.
+   */
+  virtual void Interrupt();
+
   [[nodiscard]] virtual bool Create(const IModel& model);
   [[nodiscard]] virtual bool ReadModel(IModel& model);
 
@@ -63,8 +112,51 @@ class IDatabase {
 
   virtual void Insert(const ITable& table, IItem& row,
                       const SqlFilter& filter);
+
+  /** \brief Inserts a list of rows into a table.
+   *
+   * Inserts all rows as one unit, either all rows are inserted or none.
+   * The function is used when many rows shall be inserted. The default
+   * implementation calls the Insert() function for each row but the
+   * databases should override this function with a faster solution.
+   *
+   * The item id of each row is updated with its new index.
+   * @param table Reference to the database table.
+   * @param row_list List of rows to insert.
+   * @return List of new indexes in the same order as the rows.
+   */
+  virtual std::vector<int64_t> InsertBatch(const ITable& table,
+                                           std::span<IItem> row_list);
+
+  /** \brief Bulk loads a list of rows into a table.
+   *
+   * Inserts all rows as one unit, either all rows are inserted or none.
+   * The function is intended for loading a large number of rows, for
+   * example when reading in a dump. The default implementation calls
+   * the InsertBatch() function but databases with a faster load path
+   * should override it.
+   *
+   * Note that the item id of the rows may not be updated. Use the
+   * InsertBatch() function if the new indexes are needed.
+   * @param table Reference to the database table.
+   * @param row_list List of rows to insert.
+   * @return Number of inserted rows.
+   */
+  virtual size_t BulkLoad(const ITable& table, std::span<IItem> row_list);
   virtual void Update(const ITable& table, IItem& row,
                       const SqlFilter& filter);
+
+  /** \brief Updates a list of rows in a table.
+   *
+   * Updates all rows as one unit, either all rows are updated or none.
+   * Each row is updated by its item id and only the attributes in the row
+   * are changed. The default implementation calls the Update() function
+   * for each row but the databases may override this function with a
+   * faster solution.
+   * @param table Reference to the database table.
+   * @param row_list List of rows to update.
+   */
+  virtual void UpdateBatch(const ITable& table, std::span<IItem> row_list);
   virtual void Delete(const ITable& table, const SqlFilter& filter);
 
   virtual int64_t ExecuteSql(const std::string& sql) = 0;
@@ -90,6 +182,22 @@ class IDatabase {
   virtual size_t FetchItems(const ITable& table, const SqlFilter& filter,
                           std::function<void(IItem&)> OnItem  ) = 0;
 
+  /** \brief Fetches the selected columns in column-major order.
+   *
+   * Function that only reads a few columns from a (large) table. Instead of
+   * one item per row, the values are stored in one typed vector per column.
+   *
+   * The default implementation fetches all rows as items and cannot tell
+   * a null value from an empty string. The databases should override this
+   * function and only select the requested columns.
+   * @param table Reference to the table and its columns.
+   * @param filter Reference to the where filtering definition.
+   * @param columns Column names. An empty list selects all columns.
+   * @return One column data object per column, in the requested order.
+   */
+  [[nodiscard]] virtual ColumnDataList FetchColumns(const ITable& table,
+      const SqlFilter& filter, const std::vector<std::string>& columns);
+
     /** \brief Optimize the database in size and performance.
      *
      * Function that optimize size and performance of the database. Note that
@@ -109,6 +217,8 @@ class IDatabase {
  protected:
   bool use_indexes_ = true;  ///< Flag that enable/disable automatic increment indexes;
   bool use_constraints_ = true; ///< Flag that enables/disables constraints checks
+  bool persistent_ = false; ///< Keeps the connection open between guards.
+  std::chrono::milliseconds query_timeout_ {0}; ///< 0 = No query timeout.
   IDatabase() = default;
 
   void  DatabaseType(DbType type ) {type_of_database_ = type;}
@@ -148,7 +258,26 @@ class IDatabase {
    */
   [[nodiscard]] virtual std::string MakeDateValue(const IAttribute& attr) const;
 
+  /** \brief Returns the full path to a table dump file.
+   *
+   * The dump file is named after the table in lower case with
+   * the '.dbt' extension. An empty string is returned on failure.
+   */
+  [[nodiscard]] static std::string MakeDumpFilename(const std::string& dump_dir,
+                                                    const ITable& table);
   [[nodiscard]] virtual bool DumpTable(const std::string& dump_dir, const ITable& table);
+  /** \brief Writes one row to a dump file.
+   *
+   * The columns are found through the table layout, so there is no
+   * column search for each attribute.
+   */
+  [[nodiscard]] virtual bool DumpRow(const TableLayout& layout, const IItem& row, std::ofstream& out_file) const;
+  /** \brief Writes one row to a dump file.
+   *
+   * Kept for backward compatibility. The function creates a layout for the
+   * table and calls the layout version above, which the DumpTable()
+   * function uses.
+   */
   [[nodiscard]] virtual bool DumpRow(const ITable& table, const IItem& row, std::ofstream& out_file) const;
   /** \brief Specialized insert command for inserting dump row.
    *
@@ -166,6 +295,14 @@ class IDatabase {
   virtual void EnableIndexing(bool enable);
   virtual void EnableConstraints(bool enable);
 
+  /** \brief Returns the table columns for a FetchColumns() call.
+   *
+   * Throws an exception if a column doesn't exist or isn't stored in the
+   * database.
+   */
+  [[nodiscard]] static std::vector<const IColumn*> SelectColumns(
+      const ITable& table, const std::vector<std::string>& columns);
+
  private:
   DbType type_of_database_ = DbType::TypeGeneric;
   std::string name_; ///< Database name
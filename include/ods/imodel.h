@@ -16,6 +16,7 @@
 #pragma once
 #include <map>
 #include <memory>
+#include <mutex>
 #include <util/timestamp.h>
 #include <util/stringutil.h>
 #include <util/ixmlnode.h>
@@ -256,6 +257,17 @@ class IModel {
    */
   bool DeleteTable(int64_t application_id);
 
+  /** \brief Replaces an existing table with a modified table.
+   *
+   * The table is found by its application ID and is changed in place,
+   * including its sub-tables. The name lookups are updated, so use this
+   * function instead of changing a table through a pointer if the name,
+   * database name or base ID has been changed.
+   * @param table Modified table.
+   * @return True if the table was found and updated.
+   */
+  bool UpdateTable(const ITable& table);
+
   /** \brief Adds an enumerate to the model.
    *
    * Enumerate are integer to text maps.
@@ -318,6 +330,7 @@ class IModel {
   /** Clears all tables in the model. */
   void ClearTableList() {
     table_list_.clear();
+    table_index_.Reset();
   }
 
   /** \brief Returns a list of all tables in the model.
@@ -336,7 +349,14 @@ class IModel {
   /** \brief Returns an enumerate by its name. */
   [[nodiscard]] IEnum* GetEnum(const std::string& name);
 
-  /** \brief Returns a table by its application ID. */
+  /** \brief Returns a table by its application ID.
+   *
+   * The table lookup functions below use an index over all tables in the
+   * model. The index is built on the first lookup and is updated by the
+   * AddTable(), DeleteTable() and ClearTableList() functions. Sub-tables
+   * added directly to a table in the model, aren't found until one of these
+   * functions is called.
+   */
   [[nodiscard]] const ITable* GetTable(int64_t application_id) const;
 
   /** \brief Returns a table by its application name. */
@@ -409,6 +429,36 @@ class IModel {
   EnumList enum_list_; ///< List of all enumerates.
   RelationList  relation_list_; ///< List of cross-reference tables.
 
+  struct TableIndex;
+
+  /** \brief Thread-safe holder of the lazily built table index.
+   *
+   * The index points into the table list, so a copy of the model starts
+   * without any index. The index is immutable once set, so a changed index
+   * is a new object.
+   */
+  class TableIndexCache {
+   public:
+    TableIndexCache() = default;
+    TableIndexCache(const TableIndexCache& cache);
+    TableIndexCache& operator = (const TableIndexCache& cache);
+
+    [[nodiscard]] std::shared_ptr<const TableIndex> Get() const;
+    void Set(std::shared_ptr<const TableIndex> index);
+    void Reset();
+   private:
+    mutable std::mutex lock_;
+    std::shared_ptr<const TableIndex> index_;
+  };
+  mutable TableIndexCache table_index_; ///< Table lookup index.
+
+  /** \brief Returns the table index. Builds the index if needed. */
+  [[nodiscard]] std::shared_ptr<const TableIndex> GetTableIndex(
+      bool rebuild = false) const;
+
+  /** \brief Adds a new table to an existing index. */
+  void IndexTable(const ITable& table);
+
   /** \brief Internal function that reads in the enumerates. */
   void ReadEnum(const util::xml::IXmlNode& node);
 
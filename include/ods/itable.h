@@ -3,10 +3,13 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <array>
 #include <string>
 #include <vector>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <unordered_map>
 
 #include "ods/odsdef.h"
 #include "ods/icolumn.h"
@@ -16,6 +19,8 @@ namespace ods {
 
 IColumn CreateDefaultColumn(BaseId base_id, const std::string& base_name);
 
+class TableLayout;
+
 class ITable {
  public:
 
@@ -86,9 +91,13 @@ class ITable {
     return column_list_;
   }
 
-  [[nodiscard]] ColumnList & Columns() {
-    return column_list_;
-  }
+  /** \brief Returns the column list for modifications.
+   *
+   * The column name index is rebuilt on the next lookup. Note that a name
+   * change through a reference that is kept after a later lookup, isn't
+   * detected.
+   */
+  [[nodiscard]] ColumnList & Columns();
 
   void AddSubTable(const ITable& table);
   void AddColumn(const IColumn& column);
@@ -111,6 +120,32 @@ class ITable {
   [[nodiscard]] const IColumn* GetColumnByBaseName(const std::string& name) const;
   [[nodiscard]] IColumn* GetColumnByBaseName(const std::string& name);
  private:
+  friend class TableLayout; ///< Uses the column index.
+
+  struct ColumnIndex {
+    size_t nof_columns = 0;
+    /// Lower case name to column index. One map for each name type
+    /// (application, database and base name).
+    std::array<std::unordered_map<std::string, size_t>, 3> map_list;
+  };
+
+  /** \brief Thread-safe holder of the lazily built column name index.
+   *
+   * The index is immutable once built, so copies of a table share it.
+   */
+  class ColumnIndexCache {
+   public:
+    ColumnIndexCache() = default;
+    ColumnIndexCache(const ColumnIndexCache& cache);
+    ColumnIndexCache& operator = (const ColumnIndexCache& cache);
+
+    [[nodiscard]] std::shared_ptr<const ColumnIndex> Get() const;
+    void Set(std::shared_ptr<const ColumnIndex> index);
+    void Reset();
+   private:
+    mutable std::mutex lock_;
+    std::shared_ptr<const ColumnIndex> index_;
+  };
 
   int64_t  application_id_ = 0; ///< Application ID. Shall be > 0.
   int64_t  parent_id_ = 0; ///< Parent table ID. 0 means no parent.
@@ -124,7 +159,11 @@ class ITable {
 
   SubTableList sub_table_list_;
   ColumnList column_list_; ///< List of columns
+  mutable ColumnIndexCache column_index_; ///< Case-insensitive name index.
 
+  [[nodiscard]] std::shared_ptr<const ColumnIndex> GetColumnIndex() const;
+  [[nodiscard]] const IColumn* FindColumn(size_t name_type,
+                                          const std::string& name) const;
 
 };
 
@@ -4,6 +4,7 @@
  */
 
 #pragma once
+#include <optional>
 #include <string>
 #include <vector>
 #include <sstream>
@@ -40,7 +41,9 @@ enum class SqlCondition {
 struct SqlFilterItem {
   std::string  column_name;
   SqlCondition condition;
-  std::string  value;
+  std::string  value; ///< Value as SQL text.
+  /// Unquoted value if it may be bound as a statement parameter.
+  std::optional<std::string> parameter;
 };
 
 [[nodiscard]] std::string WildcardToSql(const std::string& wildcard);
@@ -70,6 +73,20 @@ class SqlFilter {
 
   [[nodiscard]] std::string GetWhereStatement() const;
 
+  /** \brief Returns the WHERE statement with bound values.
+   *
+   * The compare and limit values are replaced by numbered parameters, so
+   * the SQL text doesn't change when only the values change. This means
+   * that the statement may be prepared once. The values are appended to
+   * the value list and the parameter numbers continue after any existing
+   * values in the list. IN lists and sub-selects are kept as SQL text.
+   * @param value_list Parameter values in parameter order.
+   * @param prefix Parameter prefix, '?' (SQLite) or '$' (Postgres).
+   * @return WHERE, ORDER BY and LIMIT statements.
+   */
+  [[nodiscard]] std::string GetWhereStatement(
+      std::vector<std::string>& value_list, char prefix = '?') const;
+
   [[nodiscard]] bool IsEmpty() const;;
 
  protected:
@@ -80,8 +97,14 @@ class SqlFilter {
   std::vector<SqlFilterItem> order_by_list_;
   std::vector<SqlFilterItem> limit_list_;
 
-  [[nodiscard]] std::string GetOrderByStatement() const;
-  [[nodiscard]] std::string GetLimitStatement() const;
+  void AddWhereItem(const IColumn& column, SqlCondition condition,
+                    const std::string& value);
+  [[nodiscard]] std::string MakeWhereStatement(
+      std::vector<std::string>* value_list, char prefix) const;
+  [[nodiscard]] std::string GetOrderByStatement(
+      std::vector<std::string>* value_list = nullptr, char prefix = '?') const;
+  [[nodiscard]] std::string GetLimitStatement(
+      std::vector<std::string>* value_list = nullptr, char prefix = '?') const;
 };
 
 template<typename T>
@@ -95,19 +118,7 @@ void SqlFilter::AddWhere(const IColumn &column, SqlCondition condition, const T&
   if (temp.str().empty() && !column.Obligatory()) {
     temp << "null";
   }
-
-  if (column.DataType() == DataType::DtString) {
-    const std::string val = MakeSqlText(temp.str());
-    SqlFilterItem item = { column.DatabaseName(), condition,val};
-    where_list_.emplace_back(item);
-  } else if (column.DataType() == DataType::DtDate) {
-    const std::string val = MakeDateText(temp.str());
-    SqlFilterItem item = { column.DatabaseName(), condition,val};
-    where_list_.emplace_back(item);
-  } else {
-    SqlFilterItem item = {column.DatabaseName(), condition, temp.str()};
-    where_list_.emplace_back(item);
-  }
+  AddWhereItem(column, condition, temp.str());
 }
 
 template<>
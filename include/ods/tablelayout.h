@@ -0,0 +1,130 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "ods/iattribute.h"
+#include "ods/icolumn.h"
+#include "ods/iitem.h"
+#include "ods/itable.h"
+
+namespace ods {
+
+/** \brief Compiled column layout of a table.
+ *
+ * The layout gives each table column an ordinal (its index in the column
+ * list) and uses the table's column name index, so a column is found
+ * without searching the column list. The name lookups are case-insensitive,
+ * same as in the IItem and ITable classes. The index is shared with the
+ * table, so a layout is cheap to create.
+ *
+ * Note that the layout references the table, so the table must outlive
+ * the layout.
+ */
+class TableLayout final {
+ public:
+  /** \brief Attribute references in column order. */
+  using AttributeRefList = std::vector<const IAttribute*>;
+
+  TableLayout() = delete;
+  explicit TableLayout(const ITable& table);
+
+  [[nodiscard]] const ITable& Table() const { return table_; }
+  [[nodiscard]] size_t NofColumns() const { return table_.Columns().size(); }
+  [[nodiscard]] const IColumn& Column(size_t ordinal) const;
+
+  /** \brief Returns the ordinal of an application name or -1 if not found. */
+  [[nodiscard]] int Ordinal(const std::string& name) const;
+  /** \brief Returns the ordinal of a base name or -1 if not found. */
+  [[nodiscard]] int BaseOrdinal(const std::string& base_name) const;
+
+  /** \brief Maps the item attributes to column order.
+   *
+   * Each item attribute is placed at its column ordinal. Columns without
+   * any attribute get a null reference. If the item has several attributes
+   * with the same name, the first one is used, same as the
+   * IItem::GetAttribute() function.
+   * @param item Item to map.
+   * @return One attribute reference per column.
+   */
+  [[nodiscard]] AttributeRefList MapItem(const IItem& item) const;
+
+ private:
+  const ITable& table_;
+  std::shared_ptr<const ITable::ColumnIndex> index_; ///< Table name index.
+
+  [[nodiscard]] int FindOrdinal(size_t name_type,
+                                const std::string& name) const;
+};
+
+/** \brief Row whose attributes are stored in column order.
+ *
+ * The row is bound to a table layout and its attributes are accessed by
+ * the column ordinal without any name search. The attributes can also be
+ * accessed by name, and the row can be converted to and from an IItem.
+ * An attribute that hasn't been set, is handled as a missing attribute in
+ * an IItem.
+ *
+ * Note that the layout must outlive the row.
+ */
+class TableRow final {
+ public:
+  TableRow() = delete;
+  explicit TableRow(const TableLayout& layout);
+  TableRow(const TableLayout& layout, const IItem& item);
+
+  [[nodiscard]] const TableLayout& Layout() const { return *layout_; }
+
+  [[nodiscard]] int64_t ItemId() const;
+  void ItemId(int64_t index);
+
+  /** \brief Returns true if the attribute has been set. */
+  [[nodiscard]] bool IsSet(size_t ordinal) const;
+  /** \brief Returns the attribute or null if it isn't set. */
+  [[nodiscard]] const IAttribute* Attribute(size_t ordinal) const;
+
+  [[nodiscard]] const IAttribute* GetAttribute(const std::string& name) const;
+  [[nodiscard]] const IAttribute* GetBaseAttribute(
+      const std::string& base_name) const;
+
+  template <typename T>
+  [[nodiscard]] T Value(size_t ordinal) const {
+    const auto* attr = Attribute(ordinal);
+    return attr == nullptr ? T {} : attr->Value<T>();
+  }
+
+  template <typename T>
+  void Value(size_t ordinal, const T& value) {
+    if (ordinal < attribute_list_.size()) {
+      attribute_list_[ordinal].Value(value);
+      set_list_[ordinal] = true;
+    }
+  }
+
+  /** \brief Clears the value of an attribute. */
+  void Reset(size_t ordinal);
+  /** \brief Clears all attribute values. */
+  void Clear();
+
+  /** \brief Replaces the row values with the item attributes.
+   *
+   * The attributes are matched by application name. Attributes without
+   * any column are ignored.
+   */
+  void Assign(const IItem& item);
+  /** \brief Returns an item with the attributes that are set. */
+  [[nodiscard]] IItem ToItem() const;
+
+ private:
+  const TableLayout* layout_ = nullptr;
+  int64_t item_id_ = 0;
+  std::vector<IAttribute> attribute_list_; ///< One attribute per column.
+  std::vector<bool> set_list_;
+};
+
+}  // namespace ods
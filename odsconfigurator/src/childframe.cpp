@@ -260,7 +260,7 @@ void ChildFrame::OnEditTable(wxCommandEvent &event) {
   if (ret != wxID_OK) {
     return;
   }
-  *selected = dialog.GetTable();
+  doc->GetModel().UpdateTable(dialog.GetTable());
   Update();
 }
 
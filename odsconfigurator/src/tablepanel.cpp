@@ -379,8 +379,7 @@ void TablePanel::OnTableActivated(wxTreeListEvent&) {
   if (ret != wxID_OK) {
     return;
   }
-  auto* update = const_cast<ITable*>(selected);
-  *update = dialog.GetTable();
+  doc->GetModel().UpdateTable(dialog.GetTable());
   Update();
 }
 
@@ -308,6 +308,7 @@ bool ReportExplorer::InitSystem() {
     return false;
   }
   database_.FileName(db_filename_);
+  database_.Profile(detail::SqliteProfile::Preset("read-mostly"));
 
   // Check if we need to create the database
   bool need_create_db = false;
@@ -0,0 +1,248 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <array>
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+
+#include "ods/columndata.h"
+
+namespace {
+
+template <typename T>
+T ParseNumber(std::string_view text) {
+  T value = {};
+  const auto first = text.find_first_not_of(" \t\r\n");
+  if (first == std::string_view::npos) {
+    return value;
+  }
+  text.remove_prefix(first);
+  if (text.front() == '+') {
+    text.remove_prefix(1);
+  }
+  std::from_chars(text.data(), text.data() + text.size(), value);
+  return value;
+}
+
+} // end namespace
+
+namespace ods {
+
+ColumnStorage DataTypeToStorage(DataType type) {
+  switch (type) {
+    case DataType::DtEnum:
+    case DataType::DtId:
+    case DataType::DtLongLong:
+    case DataType::DtLong:
+    case DataType::DtByte:
+    case DataType::DtShort:
+    case DataType::DtBoolean:
+      return ColumnStorage::Integer;
+
+    case DataType::DtDouble:
+    case DataType::DtFloat:
+      return ColumnStorage::Float;
+
+    case DataType::DtBlob:
+    case DataType::DtByteString:
+      return ColumnStorage::Bytes;
+
+    case DataType::DtExternalRef:
+    case DataType::DtDate:
+    case DataType::DtString:
+    default:
+      return ColumnStorage::Text;
+  }
+}
+
+ColumnData::ColumnData(const IColumn &column)
+: name_(column.ApplicationName()),
+  base_name_(column.BaseName()),
+  data_type_(column.DataType()),
+  storage_(DataTypeToStorage(column.DataType())) {
+}
+
+bool ColumnData::IsNull(size_t row) const {
+  if (row >= nof_rows_) {
+    return true;
+  }
+  return (null_bitmap_[row / 8] & (1U << (row % 8))) != 0;
+}
+
+size_t ColumnData::NofNulls() const {
+  size_t count = 0;
+  for (const auto byte : null_bitmap_) {
+    count += std::popcount(byte);
+  }
+  return count;
+}
+
+std::string_view ColumnData::Text(size_t row) const {
+  const auto bytes = Bytes(row);
+  return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+}
+
+std::span<const uint8_t> ColumnData::Bytes(size_t row) const {
+  if (row >= nof_rows_ || row + 1 >= offset_list_.size()) {
+    return {};
+  }
+  const auto first = offset_list_[row];
+  return {byte_list_.data() + first, offset_list_[row + 1] - first};
+}
+
+void ColumnData::Reserve(size_t nof_rows) {
+  null_bitmap_.reserve((nof_rows + 7) / 8);
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      integer_list_.reserve(nof_rows);
+      break;
+
+    case ColumnStorage::Float:
+      float_list_.reserve(nof_rows);
+      break;
+
+    default:
+      offset_list_.reserve(nof_rows + 1);
+      break;
+  }
+}
+
+void ColumnData::Clear() {
+  nof_rows_ = 0;
+  null_bitmap_.clear();
+  integer_list_.clear();
+  float_list_.clear();
+  offset_list_.assign(1, 0);
+  byte_list_.clear();
+}
+
+void ColumnData::AppendRow(bool null) {
+  if (nof_rows_ % 8 == 0) {
+    null_bitmap_.push_back(0);
+  }
+  if (null) {
+    null_bitmap_.back() |= static_cast<uint8_t>(1U << (nof_rows_ % 8));
+  }
+  ++nof_rows_;
+}
+
+void ColumnData::AppendNull() {
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      integer_list_.push_back(0);
+      break;
+
+    case ColumnStorage::Float:
+      float_list_.push_back(0.0);
+      break;
+
+    default:
+      offset_list_.push_back(byte_list_.size());
+      break;
+  }
+  AppendRow(true);
+}
+
+void ColumnData::AppendInteger(int64_t value) {
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      integer_list_.push_back(value);
+      AppendRow(false);
+      break;
+
+    case ColumnStorage::Float:
+      AppendFloat(static_cast<double>(value));
+      break;
+
+    default: {
+      const auto text = std::to_string(value);
+      AppendBytes(text.data(), text.size());
+      break;
+    }
+  }
+}
+
+void ColumnData::AppendFloat(double value) {
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      AppendInteger(static_cast<int64_t>(value));
+      break;
+
+    case ColumnStorage::Float:
+      float_list_.push_back(value);
+      AppendRow(false);
+      break;
+
+    default: {
+      std::array<char, 64> text {};
+      const auto result = std::to_chars(text.data(), text.data() + text.size(),
+                                        value);
+      AppendBytes(text.data(), result.ptr - text.data());
+      break;
+    }
+  }
+}
+
+void ColumnData::AppendBytes(const void *data, size_t nof_bytes) {
+  if (data == nullptr) {
+    nof_bytes = 0;
+  }
+  const std::string_view text(static_cast<const char*>(data), nof_bytes);
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      AppendInteger(ParseNumber<int64_t>(text));
+      break;
+
+    case ColumnStorage::Float:
+      AppendFloat(ParseNumber<double>(text));
+      break;
+
+    default: {
+      const auto* first = static_cast<const uint8_t*>(data);
+      if (nof_bytes > 0) {
+        byte_list_.insert(byte_list_.end(), first, first + nof_bytes);
+      }
+      offset_list_.push_back(byte_list_.size());
+      AppendRow(false);
+      break;
+    }
+  }
+}
+
+void ColumnData::AppendAttribute(const IAttribute *attribute) {
+  if (attribute == nullptr || attribute->IsValueEmpty()) {
+    AppendNull();
+    return;
+  }
+  switch (storage_) {
+    case ColumnStorage::Integer:
+      // Booleans may be stored as text ("t"/"f") which isn't a number.
+      if (data_type_ == DataType::DtBoolean) {
+        AppendInteger(attribute->Value<bool>() ? 1 : 0);
+      } else {
+        AppendInteger(attribute->Value<int64_t>());
+      }
+      break;
+
+    case ColumnStorage::Float:
+      AppendFloat(attribute->Value<double>());
+      break;
+
+    case ColumnStorage::Bytes: {
+      const auto bytes = attribute->Value<std::vector<uint8_t>>();
+      AppendBytes(bytes.data(), bytes.size());
+      break;
+    }
+
+    default: {
+      const auto text = attribute->Value<std::string>();
+      AppendBytes(text.data(), text.size());
+      break;
+    }
+  }
+}
+
+}  // namespace ods
@@ -14,6 +14,14 @@ DatabaseGuard::DatabaseGuard(IDatabase &database)
     } catch (const std::exception&) {
       database_ = nullptr;
     }
+  } else if (database.Persistent() && !database.InTransaction()) {
+    // Persistent connection. Only the transaction is handled by the guard.
+    try {
+      database.BeginTransaction();
+      db_ok_ = true;
+    } catch (const std::exception&) {
+      database_ = nullptr;
+    }
   } else {
     database_  = nullptr;
     db_ok_ = true;
@@ -21,8 +29,20 @@ DatabaseGuard::DatabaseGuard(IDatabase &database)
 }
 
 DatabaseGuard::~DatabaseGuard() {
-  if (database_ != nullptr) {
+  if (database_ == nullptr) {
+    return;
+  }
+  if (!database_->Persistent()) {
     database_->Close(true);
+    return;
+  }
+
+  try {
+    if (database_->InTransaction()) {
+      database_->CommitTransaction();
+    }
+  } catch (const std::exception&) {
+    Rollback();
   }
 }
 
@@ -32,10 +52,21 @@ bool DatabaseGuard::IsOk() const {
 
 void DatabaseGuard::Rollback() {
   if (database_ != nullptr) {
-    database_->Close(false);
+    if (database_->Persistent()) {
+      try {
+        if (database_->InTransaction()) {
+          database_->RollbackTransaction();
+        }
+      } catch (const std::exception&) {
+        // Something is wrong with the connection. Start with a new one.
+        database_->Close(false);
+      }
+    } else {
+      database_->Close(false);
+    }
     database_ = nullptr;
   }
   db_ok_ = false;
 }
 
-}
\ No newline at end of file
+}
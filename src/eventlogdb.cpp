@@ -2,6 +2,7 @@
  * Copyright 2022 Ingemar Hedvall
  * SPDX-License-Identifier: MIT
  */
+#include <algorithm>
 #include <chrono>
 #include <util/logstream.h>
 #include "ods/databaseguard.h"
@@ -10,11 +11,28 @@
 using namespace util::log;
 using namespace std::chrono_literals;
 
+namespace {
+// Max number of messages that are deleted and pages that are reclaimed each
+// worker cycle. Keeps the trimming short, so it doesn't delay the inserts.
+constexpr size_t kTrimBatchSize = 500;
+constexpr int64_t kVacuumPages = 100;
+// The trimming stops when the number of messages are below max - margin.
+constexpr size_t kTrimMargin = 1'000;
+}
+
 namespace ods::detail {
 EventLogDb::EventLogDb()
 : IEnvironment(EnvironmentType::kTypeEventLogDb) {
   Name("EventLogDb");
   Description("System log application that mainly is used for events.");
+  // WAL mode so the readers doesn't block the message writer.
+  // Incremental vacuum so free pages can be reclaimed without closing the
+  // database.
+  auto profile = SqliteProfile::Preset("wal");
+  profile.AutoVacuum("INCREMENTAL");
+  database_.Profile(profile);
+  // Keep the connection open between the worker thread cycles.
+  database_.Persistent(true);
 }
 
 EventLogDb::~EventLogDb() {
@@ -71,6 +89,8 @@ bool EventLogDb::Init() {
   } else {
     LOG_DEBUG() << "Read in model from the database. Database: " << DbFileName();
   }
+  ConvertAutoVacuum();
+  nof_messages_ = GetNofMessages();
 
   is_ok_ = true;
   return true;
@@ -115,6 +135,7 @@ void EventLogDb::Stop() {
       input->Stop();
     }
   }
+  database_.Close(true);
   LOG_DEBUG() << "Worker thread stopped. Environment: " << Name();
 }
 
@@ -170,6 +191,7 @@ void EventLogDb::AddMessage(const util::syslog::SyslogMessage &msg) {
     LOG_ERROR() << "Syslog insert failed. Error: " << err.what();
     return;
   }
+  ++nof_messages_;
 
   const auto log_index = log_row.ItemId();
 
@@ -272,32 +294,67 @@ size_t EventLogDb::GetNofMessages() {
   return 0;
 }
 
+void EventLogDb::ConvertAutoVacuum() {
+  // Databases created before the incremental vacuum, needs a one-time
+  // VACUUM.
+  try {
+    bool incremental = false;
+    {
+      DatabaseGuard db_lock(Database());
+      incremental = db_lock.IsOk() && database_.AutoVacuum() == 2;
+    }
+    if (!incremental) {
+      LOG_DEBUG() << "Converting to incremental vacuum. Database: " << db_file_;
+      database_.Close(true); // The persistent connection must be closed.
+      database_.Vacuum();
+    }
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Conversion to incremental vacuum failed. Error: "
+                << err.what();
+  }
+}
+
 void EventLogDb::DoTrimDatabase() {
-  if (nof_messages_ < max_nof_messages_) {
+  const auto* table = model_.GetTableByName("Syslog");
+  const auto* column_id = table != nullptr ? table->GetColumnByBaseName("id"): nullptr;
+  if (table == nullptr || column_id == nullptr) {
     return;
   }
-  const auto* table = model_.GetTableByName("Syslog");
-  const auto* column_stored = table != nullptr ? table->GetColumnByBaseName("version_date"): nullptr;
 
-  if (table == nullptr || column_stored == nullptr) {
-    return;
+  if (nof_messages_ >= max_nof_messages_) {
+    trimming_ = true;
   }
-  { // Must close the database before Vacuum() call
-    DatabaseGuard db_lock(Database()); // Open and close for each input with messages
-    size_t delete_rows = nof_messages_ - (max_nof_messages_ - 1'000);
+  const size_t low_limit = max_nof_messages_ - kTrimMargin;
+  DatabaseGuard db_lock(Database());
+  if (trimming_ && db_lock.IsOk()) {
+    // Delete the oldest messages in small batches, one batch each cycle.
+    const size_t delete_rows = std::min(
+        nof_messages_ > low_limit ? nof_messages_ - low_limit : 0,
+        kTrimBatchSize);
+    SqlFilter oldest;
+    oldest.AddOrder(*column_id, SqlCondition::OrderByNone);
+    oldest.AddLimit(SqlCondition::LimitNofRows, delete_rows);
     SqlFilter filter;
-    filter.AddOrder(*column_stored, SqlCondition::OrderByNone);
-    filter.AddLimit(SqlCondition::LimitNofRows, static_cast<int64_t>(delete_rows));
+    filter.AddWhereSelect(*column_id, SqlCondition::In, *table, oldest);
     try {
       Database().Delete(*table, filter);
+      nof_messages_ -= std::min(delete_rows, nof_messages_.load());
     } catch (const std::exception &err) {
       LOG_ERROR() << "Deleting messages failed. Error: " << err.what();
+      db_lock.Rollback();
+      return;
     }
+    trimming_ = nof_messages_ > low_limit;
   }
+
+  // Reclaim some of the free pages each cycle instead of a full VACUUM.
   try {
-    Database().Vacuum();
+    if (db_lock.IsOk()) {
+      database_.IncrementalVacuum(kVacuumPages);
+    }
   } catch (const std::exception& err) {
-    LOG_ERROR() << "Vacumm of database failed. Error: " << err.what();
+    LOG_ERROR() << "Incremental vacuum of database failed. Error: "
+                << err.what();
   }
 }
 
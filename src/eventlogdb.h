@@ -46,6 +46,10 @@ class EventLogDb : public IEnvironment {
   void Start() override;
   void Stop() override;
 
+  IDatabase& Database() override {
+    return database_;
+  }
+
  private:
   std::string db_file_;     ///< Database file name with full path.
   SqliteDatabase database_; ///< ODS database
@@ -60,12 +64,14 @@ class EventLogDb : public IEnvironment {
   InputList input_list_;
   std::atomic<size_t> nof_messages_ = 0;
   size_t max_nof_messages_ = 1'000'000;
+  bool trimming_ = false; ///< True while old messages are deleted.
 
   void WorkerThread();
   void AddMessage(const util::syslog::SyslogMessage& msg);
   void DoAllInputMessages();
   void DoTrimDatabase();
   size_t GetNofMessages();
+  void ConvertAutoVacuum();
 
   int64_t AddHostname(const std::string& hostname);
   int64_t AddAppName(const std::string& app_name);
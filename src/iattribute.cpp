@@ -15,13 +15,13 @@ namespace ods {
 
 IAttribute::IAttribute(std::string name, const char* value)
 : name_(std::move(name)),
-  value_(value != nullptr ? value : "") {
+  value_(std::string(value != nullptr ? value : "")) {
 }
 
 IAttribute::IAttribute(std::string name, std::string  base_name, const char* value)
 : name_(std::move(name)),
   base_name_(std::move(base_name)),
-  value_(value != nullptr ? value : "") {
+  value_(std::string(value != nullptr ? value : "")) {
 }
 
 const std::string &IAttribute::BaseName() const {
@@ -38,27 +38,58 @@ void IAttribute::Name(const std::string &name) {
   name_ = name;
 }
 
+std::string IAttribute::Text() const {
+  return std::visit([] (const auto& value) -> std::string {
+    using T = std::decay_t<decltype(value)>;
+    if constexpr (std::is_same_v<T, std::string>) {
+      return value;
+    } else if constexpr (std::is_same_v<T, bool>) {
+      return value ? "1" : "0";
+    } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
+      return OdsHelper::ToBase64(value);
+    } else if constexpr (std::is_floating_point_v<T>) {
+      char temp[80] = {'\0'};
+      std::to_chars(temp, temp + 78, value );
+      return temp;
+    } else {
+      return std::to_string(value);
+    }
+  }, value_);
+}
+
 bool IAttribute::IsValueUnsigned() const {
-  if (value_.empty()) {
+  if (const auto* number = std::get_if<int64_t>(&value_)) {
+    return *number >= 0;
+  }
+  if (std::holds_alternative<uint64_t>(value_) ||
+      std::holds_alternative<bool>(value_)) {
+    return true;
+  }
+  const auto text = Text();
+  if (text.empty()) {
     return false;
   }
   // Must be all number
-  return std::ranges::all_of(value_, [&] (const char& input) ->bool {
+  return std::ranges::all_of(text, [&] (const char& input) ->bool {
     return ::isdigit(input);
   });
 }
 
 template<>
 std::string IAttribute::Value() const {
-  return value_;
+  return Text();
 }
 
 template <>
 [[nodiscard]] bool IAttribute::Value() const {
-  if (value_.empty()) {
+  if (const auto* flag = std::get_if<bool>(&value_)) {
+    return *flag;
+  }
+  const auto text = Text();
+  if (text.empty()) {
     return false;
   }
-  switch (value_[0]) {
+  switch (text[0]) {
     case '1':
     case 't':
     case 'T':
@@ -73,26 +104,57 @@ template <>
 
 template<>
 std::vector<uint8_t> IAttribute::Value() const {
-  return OdsHelper::FromBase64(value_);
+  if (const auto* bytes = std::get_if<std::vector<uint8_t>>(&value_)) {
+    return *bytes;
+  }
+  return OdsHelper::FromBase64(Text());
 }
 
 template<>
 float IAttribute::Value() const {
-  if (value_.empty()) {
+  // A double is parsed from its text, so it rounds the same way as before.
+  if (const auto* number = std::get_if<float>(&value_)) {
+    return *number;
+  }
+  if (const auto* number = std::get_if<int64_t>(&value_)) {
+    return static_cast<float>(*number);
+  }
+  if (const auto* number = std::get_if<uint64_t>(&value_)) {
+    return static_cast<float>(*number);
+  }
+  if (const auto* flag = std::get_if<bool>(&value_)) {
+    return *flag ? 1.0F : 0.0F;
+  }
+  const auto text = Text();
+  if (text.empty()) {
     return 0.0F;
   }
   float value = 0.0F;
-  std::from_chars(value_.data(), value_.data() + value_.size(), value);
+  std::from_chars(text.data(), text.data() + text.size(), value);
   return value;
 }
 
 template<>
 double IAttribute::Value() const {
-  if (value_.empty()) {
+  // A float is parsed from its text, so 1.23F is read as 1.23.
+  if (const auto* number = std::get_if<double>(&value_)) {
+    return *number;
+  }
+  if (const auto* number = std::get_if<int64_t>(&value_)) {
+    return static_cast<double>(*number);
+  }
+  if (const auto* number = std::get_if<uint64_t>(&value_)) {
+    return static_cast<double>(*number);
+  }
+  if (const auto* flag = std::get_if<bool>(&value_)) {
+    return *flag ? 1.0 : 0.0;
+  }
+  const auto text = Text();
+  if (text.empty()) {
     return 0.0;
   }
   double value = 0.0;
-  std::from_chars(value_.data(), value_.data() + value_.size(), value);
+  std::from_chars(text.data(), text.data() + text.size(), value);
   return value;
 }
 
@@ -103,31 +165,26 @@ void IAttribute::Value(std::string value) {
 
 template <>
 void IAttribute::Value(double value) {
-  char temp[80] = {'\0'};
-  std::to_chars(temp, temp + 78, value );
-  value_ = temp;
+  value_ = value;
 }
 
 template <>
 void IAttribute::Value(float value) {
-  char temp[80] = {'\0'};
-  std::to_chars(temp, temp + 78, value );
-  value_ = temp;
+  value_ = value;
 }
 
 template <>
 void IAttribute::Value(bool value) {
-  value_ = value ? "1" : "0";
+  value_ = value;
 }
 
 template <>
 void IAttribute::Value(std::vector<uint8_t> value) {
-  const auto temp = std::move(value);
-  value_ = OdsHelper::ToBase64(temp);
+  value_ = std::move(value);
 }
 
 template <>
 void IAttribute::Value(const char* value) {
-  value_ = value != nullptr ? value : "";
+  value_ = std::string(value != nullptr ? value : "");
 }
 } // end namespace
\ No newline at end of file
@@ -16,6 +16,7 @@
 #include <util/timestamp.h>
 
 #include "ods/databaseguard.h"
+#include "ods/tablelayout.h"
 #include "odshelper.h"
 using namespace util::log;
 using namespace util::string;
@@ -25,6 +26,8 @@ using namespace std::chrono;
 
 namespace {
 
+constexpr size_t kReadInBatchSize = 1'000; ///< Number of rows per insert batch
+
 constexpr std::string_view kCreateSvcEnum =
     "CREATE TABLE IF NOT EXISTS SVCENUM ("
     "ENUMID  integer NOT NULL, "
@@ -256,6 +259,60 @@ void IDatabase::Vacuum() {
   // By default, this function doesn't do anything.
 }
 
+ColumnDataList IDatabase::FetchColumns(const ITable &table,
+    const SqlFilter &filter, const std::vector<std::string> &columns) {
+  const auto select_list = SelectColumns(table, columns);
+  ColumnDataList data_list;
+  data_list.reserve(select_list.size());
+  for (const auto* column : select_list) {
+    data_list.emplace_back(*column);
+  }
+
+  // The column ordinals are resolved once, so each row is only mapped.
+  const TableLayout layout(table);
+  std::vector<int> ordinal_list;
+  ordinal_list.reserve(select_list.size());
+  for (const auto* column : select_list) {
+    ordinal_list.push_back(layout.Ordinal(column->ApplicationName()));
+  }
+
+  FetchItems(table, filter, [&] (IItem& row) -> void {
+    const auto attr_list = layout.MapItem(row);
+    for (size_t index = 0; index < ordinal_list.size(); ++index) {
+      const int ordinal = ordinal_list[index];
+      data_list[index].AppendAttribute(ordinal >= 0 ?
+                                       attr_list[ordinal] : nullptr);
+    }
+  });
+  return data_list;
+}
+
+std::vector<const IColumn *> IDatabase::SelectColumns(const ITable &table,
+    const std::vector<std::string> &columns) {
+  std::vector<const IColumn*> select_list;
+  if (columns.empty()) {
+    for (const auto& column : table.Columns()) {
+      if (!column.DatabaseName().empty()) {
+        select_list.push_back(&column);
+      }
+    }
+    return select_list;
+  }
+
+  select_list.reserve(columns.size());
+  for (const auto& name : columns) {
+    const auto* column = table.GetColumnByName(name);
+    if (column == nullptr || column->DatabaseName().empty()) {
+      std::ostringstream err;
+      err << "The column doesn't exist in the database. Column: " << name
+          << ", Table: " << table.ApplicationName();
+      throw std::runtime_error(err.str());
+    }
+    select_list.push_back(column);
+  }
+  return select_list;
+}
+
 void IDatabase::ExportCsv(const std::string& filename, const ITable &table, const SqlFilter &filter) {
   // This method should only be used for tables with a small number of rows.
   util::plot::CsvWriter csv_file(filename);
@@ -265,12 +322,15 @@ void IDatabase::ExportCsv(const std::string& filename, const ITable &table, cons
   }
   ItemList data_list;
   FetchItemList(table, data_list, filter);
+  const TableLayout layout(table);
   for (const auto& row : data_list) {
     if (!row) {
       continue;
     }
-    for (const auto& column : column_list) {
-      const auto* attr = row->GetAttribute(column.ApplicationName());
+    const auto attr_list = layout.MapItem(*row);
+    for (size_t ordinal = 0; ordinal < column_list.size(); ++ordinal) {
+      const auto& column = column_list[ordinal];
+      const auto* attr = attr_list[ordinal];
       if (attr == nullptr) {
         csv_file.AddColumnValue(std::string());
         continue;
@@ -917,11 +977,14 @@ void IDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& filter)
     return;
   }
 
+  const TableLayout layout(table);
+  const auto attr_list = layout.MapItem(row);
   std::ostringstream insert;
   std::ostringstream values;
   insert << "INSERT INTO " << table.DatabaseName() << " (";
   bool first = true;
-  for (const auto &col: column_list) {
+  for (size_t ordinal = 0; ordinal < column_list.size(); ++ordinal) {
+    const auto& col = column_list[ordinal];
     if (IEquals(col.BaseName(), "id") || col.DatabaseName().empty()) {
       continue;
     }
@@ -932,7 +995,7 @@ void IDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& filter)
       first = false;
     }
     insert << col.DatabaseName();
-    const auto *attr = row.GetAttribute(col.ApplicationName());
+    const auto *attr = attr_list[ordinal];
     if (attr != nullptr) {
       // The user has set the item
       switch (col.DataType()) {
@@ -1001,6 +1064,87 @@ void IDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& filter)
   row.ItemId(idx);
 }
 
+void IDatabase::BeginTransaction() {
+  ExecuteSql("BEGIN");
+}
+
+void IDatabase::CommitTransaction() {
+  ExecuteSql("COMMIT");
+}
+
+void IDatabase::RollbackTransaction() {
+  ExecuteSql("ROLLBACK");
+}
+
+bool IDatabase::InTransaction() const {
+  // The default databases start a transaction when they are opened.
+  return IsOpen();
+}
+
+void IDatabase::QueryTimeout(std::chrono::milliseconds timeout) {
+  query_timeout_ = timeout < std::chrono::milliseconds(0) ?
+      std::chrono::milliseconds(0) : timeout;
+}
+
+void IDatabase::Interrupt() {
+  // By default, this function doesn't do anything.
+}
+
+std::vector<int64_t> IDatabase::InsertBatch(const ITable &table,
+                                            std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+  std::vector<int64_t> index_list;
+  index_list.reserve(row_list.size());
+
+  // The save point makes it possible to roll back the batch only.
+  ExecuteSql("SAVEPOINT insert_batch");
+  try {
+    const SqlFilter empty_filter;
+    for (IItem& row : row_list) {
+      Insert(table, row, empty_filter);
+      index_list.push_back(row.ItemId());
+    }
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT insert_batch");
+    ExecuteSql("RELEASE SAVEPOINT insert_batch");
+    throw;
+  }
+  ExecuteSql("RELEASE SAVEPOINT insert_batch");
+  return index_list;
+}
+
+void IDatabase::UpdateBatch(const ITable &table, std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+  const auto* id_column = table.GetColumnByBaseName("id");
+  if (id_column == nullptr || row_list.empty()) {
+    return;
+  }
+
+  // The save point makes it possible to roll back the batch only.
+  ExecuteSql("SAVEPOINT update_batch");
+  try {
+    for (IItem& row : row_list) {
+      SqlFilter filter;
+      filter.AddWhere(*id_column, SqlCondition::Equal, row.ItemId());
+      Update(table, row, filter);
+    }
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT update_batch");
+    ExecuteSql("RELEASE SAVEPOINT update_batch");
+    throw;
+  }
+  ExecuteSql("RELEASE SAVEPOINT update_batch");
+}
+
+size_t IDatabase::BulkLoad(const ITable &table, std::span<IItem> row_list) {
+  const auto index_list = InsertBatch(table, row_list);
+  return index_list.size();
+}
+
 
 void IDatabase::Update(const ITable &table, IItem &row, const SqlFilter& filter) {
   if (!IsOpen()) {
@@ -1192,6 +1336,22 @@ bool IDatabase::SaveModelFile(const std::string &dump_dir, const IModel &model)
   return save;
 }
 
+std::string IDatabase::MakeDumpFilename(const std::string &dump_dir,
+                                        const ITable &table) {
+  std::string filename;
+  try {
+    path dump_file(dump_dir);
+    std::string dump_name = table.DatabaseName() + ".dbt";
+    std::transform(dump_name.cbegin(), dump_name.cend(), dump_name.begin(), ::tolower);
+    dump_file.append(dump_name);
+    filename = dump_file.string();
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to create a dump file. File: " << filename << ", Error: " << err.what();
+    filename.clear();
+  }
+  return filename;
+}
+
 bool IDatabase::DumpTable(const std::string &dump_dir, const ITable &table) {
   if (table.DatabaseName().empty()) {
     return true;
@@ -1211,15 +1371,8 @@ bool IDatabase::DumpTable(const std::string &dump_dir, const ITable &table) {
   }
 
   // Create and open a dump file.
-  std::string filename;
-  try {
-    path dump_file(dump_dir);
-    std::string dump_name = table.DatabaseName() + ".dbt";
-    std::transform(dump_name.cbegin(), dump_name.cend(), dump_name.begin(), ::tolower);
-    dump_file.append(dump_name);
-    filename = dump_file.string();
-  } catch (const std::exception& err) {
-    LOG_ERROR() << "Failed to create a dump file. File: " << filename << ", Error: " << err.what();
+  const std::string filename = MakeDumpFilename(dump_dir, table);
+  if (filename.empty()) {
     return false;
   }
   std::ofstream out_file(filename,std::ios_base::out | std::ios_base::trunc );
@@ -1228,8 +1381,9 @@ bool IDatabase::DumpTable(const std::string &dump_dir, const ITable &table) {
     return false;
   }
   size_t failed_rows = 0;
+  const TableLayout layout(table);
   const size_t nof_rows = FetchItems(table, fetch_all, [&] (IItem& row) -> void {
-    const bool dump_row = DumpRow(table, row, out_file);
+    const bool dump_row = DumpRow(layout, row, out_file);
     if (!dump_row) {
       ++failed_rows;
     }
@@ -1239,11 +1393,17 @@ bool IDatabase::DumpTable(const std::string &dump_dir, const ITable &table) {
 }
 
 bool IDatabase::DumpRow(const ITable &table, const IItem &row, std::ofstream &out_file) const {
+  const TableLayout layout(table);
+  return DumpRow(layout, row, out_file);
+}
 
+bool IDatabase::DumpRow(const TableLayout &layout, const IItem &row, std::ofstream &out_file) const {
+  const auto& table = layout.Table();
   bool dump_row = true;
   for (const auto& attribute : row.AttributeList()) {
     const auto& name = attribute.Name();
-    const auto* column = table.GetColumnByName(name);
+    const auto ordinal = layout.Ordinal(name);
+    const auto* column = ordinal < 0 ? nullptr : &layout.Column(ordinal);
     if (column == nullptr) {
       LOG_ERROR() << "Column not found in the database model. Dump mismatch. Table/Column: "
         << table.DatabaseName() << "/" << name;
@@ -1508,6 +1668,28 @@ bool IDatabase::ReadInTable(const ITable &table, const std::string &dbt_file) {
     size_t unique_idx = 0; // Keeps track of suspicious indexes (<= 0)
 
     SqlFilter empty_filter;
+    std::vector<IItem> row_list;
+    row_list.reserve(kReadInBatchSize);
+    auto InsertRows = [&] () {
+      if (row_list.empty()) {
+        return;
+      }
+      try {
+        BulkLoad(table, row_list);
+      } catch (const std::exception& ) {
+        // Insert the rows one by one so the bad rows are logged and skipped.
+        for (IItem& item : row_list) {
+          try {
+            Insert(table, item, empty_filter);
+          } catch (const std::exception &err) {
+            LOG_ERROR() << "Failed read in a dump file. Error: " << err.what() << ", File: " << dbt_file;
+            ++nof_fails;
+          }
+        }
+      }
+      row_list.clear();
+    };
+
     IItem row;
     for (bool more = OdsHelper::FetchDbtRow(table, row, file);
          more; more = OdsHelper::FetchDbtRow(table, row, file)) {
@@ -1517,7 +1699,6 @@ bool IDatabase::ReadInTable(const ITable &table, const std::string &dbt_file) {
         continue;
       }
       const int64_t idx = row.ItemId();
-      const std::string name = row.Name();
       if (id_column != nullptr && id_column->Unique() && idx <= 0) {
         ++unique_idx;
         if (unique_idx >= 2) {
@@ -1525,14 +1706,13 @@ bool IDatabase::ReadInTable(const ITable &table, const std::string &dbt_file) {
         }
       }
 
-       try {
-        Insert(table, row, empty_filter);
-      } catch (const std::exception &err) {
-        LOG_ERROR() << "Failed read in a dump file. Error: " << err.what() << ", File: " << dbt_file;
-        ++nof_fails;
+      row_list.push_back(row);
+      if (row_list.size() >= kReadInBatchSize) {
+        InsertRows();
       }
       ++nof_rows;
     } // end for loop
+    InsertRows();
 
     if (unique_idx == 2) {
       LOG_INFO() << "Skipped " << unique_idx - 1 << " rows. Table/Idx: " << table.DatabaseName() << "/<0";
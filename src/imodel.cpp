@@ -5,7 +5,10 @@
 
 #include <filesystem>
 #include <algorithm>
+#include <cctype>
 #include <ranges>
+#include <unordered_map>
+#include <utility>
 
 #include "ods/itable.h"
 #include "ods/imodel.h"
@@ -201,9 +204,67 @@ void AddSubTable(const ods::ITable& table, std::vector<const ods::ITable*>& list
   }
 }
 
+std::string MakeKey(const std::string& name) {
+  std::string key = name;
+  std::ranges::transform(key, key.begin(), [] (unsigned char input) {
+    return static_cast<char>(std::tolower(input));
+  });
+  return key;
+}
+
+template <typename T>
+const ods::ITable* FindIndex(const T& map, const typename T::key_type& key) {
+  const auto itr = map.find(key);
+  return itr == map.cend() ? nullptr : itr->second;
+}
+
 }
 namespace ods {
 
+struct IModel::TableIndex {
+  std::unordered_map<int64_t, const ITable*> id_map;
+  std::unordered_map<std::string, const ITable*> name_map; ///< Lower case.
+  std::unordered_map<std::string, const ITable*> db_map; ///< Lower case.
+  std::unordered_map<BaseId, const ITable*> base_map;
+
+  /** \brief Adds a table and its sub-tables. The first table wins. */
+  void Add(const ITable& table) { //NOLINT
+    id_map.emplace(table.ApplicationId(), &table);
+    name_map.emplace(MakeKey(table.ApplicationName()), &table);
+    db_map.emplace(MakeKey(table.DatabaseName()), &table);
+    base_map.emplace(table.BaseId(), &table);
+    for (const auto& [sub_id, sub_table] : table.SubTables()) {
+      Add(sub_table);
+    }
+  }
+};
+
+IModel::TableIndexCache::TableIndexCache(const TableIndexCache&) {
+}
+
+IModel::TableIndexCache &IModel::TableIndexCache::operator=(
+    const TableIndexCache &cache) {
+  if (this != &cache) {
+    Reset();
+  }
+  return *this;
+}
+
+std::shared_ptr<const IModel::TableIndex> IModel::TableIndexCache::Get()
+    const {
+  std::lock_guard lock(lock_);
+  return index_;
+}
+
+void IModel::TableIndexCache::Set(std::shared_ptr<const TableIndex> index) {
+  std::lock_guard lock(lock_);
+  index_ = std::move(index);
+}
+
+void IModel::TableIndexCache::Reset() {
+  Set({});
+}
+
 bool IModel::operator == (const IModel &model) const {
   if (name_ != model.name_) return false;
   if (version_ != model.version_) return false;
@@ -290,8 +351,15 @@ void IModel::AddTable(const ITable &table) { //NOLINT
   auto* parent = copy.ParentId() != 0 ? const_cast<ITable*>(GetTable(copy.ParentId())) : nullptr;
   if (parent != nullptr) {
     parent->AddSubTable(copy);
+    const auto itr = parent->SubTables().find(copy.ApplicationId());
+    if (itr != parent->SubTables().cend()) {
+      IndexTable(itr->second);
+    }
   } else {
-    table_list_.insert({copy.ApplicationId(), copy});
+    const auto [itr, inserted] = table_list_.insert({copy.ApplicationId(), copy});
+    if (inserted) {
+      IndexTable(itr->second);
+    }
   }
 
   // Add all sub-tables again so they get the right references
@@ -350,7 +418,7 @@ bool IModel::ReadModel(const std::string &filename) {
     LOG_ERROR() << "Invalid root tag. Tag: " << xml_file->RootName() << ", File: " << filename;
     return false;
   }
-  table_list_.clear();
+  ClearTableList();
   enum_list_.clear();
   Name(xml_file->Property("Name",std::string("")));
   if (Name().empty()) {
@@ -567,18 +635,53 @@ void IModel::ReadTable(const IXmlNode &node) {
   AddTable(table);
 }
 
-const ITable *IModel::GetTable(int64_t application_id) const {
-  const auto itr = table_list_.find(application_id);
-  if (itr != table_list_.cend()) {
-    return &itr->second;
-  }
-  for (const auto& table : table_list_ ) {
-    const auto* find = table.second.GetTable(application_id);
-    if (find != nullptr) {
-     return find;
+std::shared_ptr<const IModel::TableIndex> IModel::GetTableIndex(
+    bool rebuild) const {
+  if (!rebuild) {
+    if (auto index = table_index_.Get(); index) {
+      return index;
     }
   }
-  return nullptr;
+  auto index = std::make_shared<TableIndex>();
+  // The top-most tables are searched first for the base ID.
+  for (const auto& [table_id, table] : table_list_) {
+    index->base_map.emplace(table.BaseId(), &table);
+  }
+  for (const auto& [table_id, table] : table_list_) {
+    index->Add(table);
+  }
+  table_index_.Set(index);
+  return index;
+}
+
+void IModel::IndexTable(const ITable &table) {
+  const auto index = table_index_.Get();
+  if (!index) {
+    return; // Built on the next lookup
+  }
+  // A new table never has any sub-tables, but it may hide an existing table
+  // with the same name or base ID. That case is solved by a rebuild.
+  const bool exist = index->id_map.contains(table.ApplicationId()) ||
+      index->name_map.contains(MakeKey(table.ApplicationName())) ||
+      index->db_map.contains(MakeKey(table.DatabaseName())) ||
+      index->base_map.contains(table.BaseId());
+  if (exist || !table.SubTables().empty()) {
+    table_index_.Reset();
+    return;
+  }
+  // Other threads may use the current index, so a copy is updated.
+  auto new_index = std::make_shared<TableIndex>(*index);
+  new_index->Add(table);
+  table_index_.Set(new_index);
+}
+
+const ITable *IModel::GetTable(int64_t application_id) const {
+  const auto* table = FindIndex(GetTableIndex()->id_map, application_id);
+  if (table != nullptr && table->ApplicationId() != application_id) {
+    // The table has been changed after the index was built.
+    table = FindIndex(GetTableIndex(true)->id_map, application_id);
+  }
+  return table;
 }
 
 const IEnum *IModel::GetEnum(const std::string& name) const {
@@ -592,63 +695,35 @@ IEnum *IModel::GetEnum(const std::string& name) {
 }
 
 const ITable *IModel::GetTableByBaseId(BaseId base) const {
-    // Search on top level first which is the normal case for this function
-  const auto itr1 = std::ranges::find_if(table_list_, [&] (const auto& itr) {
-    return itr.second.BaseId() == base;
-  });
-  if (itr1 != table_list_.cend()) {
-    return &itr1->second;
-  }
-    // Plan B is to do a deep search
-  for (const auto& itr2 : table_list_) {
-    const auto* table = itr2.second.GetBaseId(base);
-    if (table != nullptr) {
-      return table;
-    }
+  const auto* table = FindIndex(GetTableIndex()->base_map, base);
+  if (table != nullptr && table->BaseId() != base) {
+    table = FindIndex(GetTableIndex(true)->base_map, base);
   }
-  return nullptr;
+  return table;
 }
 
 ITable *IModel::GetTableByBaseId(BaseId base) {
-  // Search on top level first which is the normal case for this function
-  auto itr1 = std::ranges::find_if(table_list_, [&] (const auto& itr) -> bool {
-    return itr.second.BaseId() == base;
-  });
-
-  if (itr1 != table_list_.end()) {
-    return &itr1->second;
-  }
-
-  // Plan B is to do a deep search
-  for (auto& [name, table] : table_list_) {
-    ITable* sub_table = table.GetBaseId(base);
-    if (sub_table != nullptr) {
-      return sub_table;
-    }
-  }
-  return nullptr;
+  return const_cast<ITable*>(std::as_const(*this).GetTableByBaseId(base));
 }
 
 const ITable *IModel::GetTableByName(const std::string &name) const {
-  for (const auto& itr : table_list_) {
-    const auto& table = itr.second;
-    const auto* find = table.GetTableByName(name);
-    if (find != nullptr) {
-      return find;
-    }
+  const auto key = MakeKey(name);
+  const auto* table = FindIndex(GetTableIndex()->name_map, key);
+  if (table != nullptr && !util::string::IEquals(table->ApplicationName(),
+                                                 name)) {
+    table = FindIndex(GetTableIndex(true)->name_map, key);
   }
-  return GetTableByDbName(name);
+  return table != nullptr ? table : GetTableByDbName(name);
 }
 
 const ITable *IModel::GetTableByDbName(const std::string &name) const {
-  for (const auto& itr : table_list_) {
-    const auto& table = itr.second;
-    const auto* find = table.GetTableByDbName(name);
-    if (find != nullptr) {
-      return find;
-    }
+  const auto key = MakeKey(name);
+  const auto* table = FindIndex(GetTableIndex()->db_map, key);
+  if (table != nullptr && !util::string::IEquals(table->DatabaseName(),
+                                                 name)) {
+    table = FindIndex(GetTableIndex(true)->db_map, key);
   }
-  return nullptr;
+  return table;
 }
 
 int64_t IModel::FindNextTableId(int64_t parent_id) const {
@@ -683,16 +758,28 @@ bool IModel::DeleteTable(int64_t application_id) {
   for (auto itr = table_list_.begin(); itr != table_list_.end(); ++itr) {
     if (itr->second.ApplicationId() == application_id) {
       table_list_.erase(itr);
+      table_index_.Reset();
       return true;
     }
     const auto sub = itr->second.DeleteSubTable(application_id);
     if (sub) {
+      table_index_.Reset();
       return true;
     }
   }
   return false;
 }
 
+bool IModel::UpdateTable(const ITable &table) {
+  auto* exist = const_cast<ITable*>(GetTable(table.ApplicationId()));
+  if (exist == nullptr) {
+    return false;
+  }
+  *exist = table;
+  table_index_.Reset();
+  return true;
+}
+
 std::vector<const ITable*> IModel::AllTables() const {
   std::vector<const ITable*> temp_list;
   for (const auto& [table_name, table1] : table_list_) {
@@ -3,13 +3,74 @@
  * SPDX-License-Identifier: MIT
  */
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <unordered_map>
+#include <utility>
 #include "util/stringutil.h"
 #include "ods/itable.h"
 #include "ods/baseattribute.h"
 using namespace util::string;
 
+namespace {
+
+constexpr size_t kApplicationName = 0;
+constexpr size_t kDatabaseName = 1;
+constexpr size_t kBaseName = 2;
+
+std::string MakeKey(const std::string& name) {
+  std::string key = name;
+  std::ranges::transform(key, key.begin(), [] (unsigned char input) {
+    return static_cast<char>(std::tolower(input));
+  });
+  return key;
+}
+
+const std::string& ColumnName(const ods::IColumn& column, size_t name_type) {
+  switch (name_type) {
+    case kDatabaseName:
+      return column.DatabaseName();
+
+    case kBaseName:
+      return column.BaseName();
+
+    default:
+      break;
+  }
+  return column.ApplicationName();
+}
+
+} // end namespace
+
 namespace ods {
 
+ITable::ColumnIndexCache::ColumnIndexCache(const ColumnIndexCache &cache)
+: index_(cache.Get()) {
+}
+
+ITable::ColumnIndexCache &ITable::ColumnIndexCache::operator=(
+    const ColumnIndexCache &cache) {
+  if (this != &cache) {
+    Set(cache.Get());
+  }
+  return *this;
+}
+
+std::shared_ptr<const ITable::ColumnIndex> ITable::ColumnIndexCache::Get()
+    const {
+  std::lock_guard lock(lock_);
+  return index_;
+}
+
+void ITable::ColumnIndexCache::Set(std::shared_ptr<const ColumnIndex> index) {
+  std::lock_guard lock(lock_);
+  index_ = std::move(index);
+}
+
+void ITable::ColumnIndexCache::Reset() {
+  Set({});
+}
+
 IColumn CreateDefaultColumn(BaseId base_id, const std::string &base_name) {
   IColumn column;
   if (!base_name.empty()) {
@@ -53,6 +114,12 @@ bool ITable::operator==(const ITable &table) const {
 
 void ods::ITable::AddColumn(const IColumn& column) {
   column_list_.push_back(column);
+  column_index_.Reset();
+}
+
+ITable::ColumnList &ITable::Columns() {
+  column_index_.Reset();
+  return column_list_;
 }
 
 void ITable::AddSubTable(const ITable& table) {
@@ -130,32 +197,72 @@ const ITable *ITable::GetTableByDbName(const std::string& name) const {
   return nullptr;
 }
 
-const IColumn *ITable::GetColumnByName(const std::string &name) const {
-  const auto itr = std::ranges::find_if(column_list_, [&] (const auto& column) {
-    return util::string::IEquals(name,column.ApplicationName());
+std::shared_ptr<const ITable::ColumnIndex> ITable::GetColumnIndex() const {
+  auto index = column_index_.Get();
+  if (index && index->nof_columns == column_list_.size()) {
+    return index;
+  }
+
+  auto new_index = std::make_shared<ColumnIndex>();
+  new_index->nof_columns = column_list_.size();
+  for (size_t name_type = 0; name_type < new_index->map_list.size();
+       ++name_type) {
+    auto& map = new_index->map_list[name_type];
+    map.reserve(column_list_.size());
+    for (size_t ordinal = 0; ordinal < column_list_.size(); ++ordinal) {
+      // The first column wins, same as the previous linear search.
+      map.emplace(MakeKey(ColumnName(column_list_[ordinal], name_type)),
+                  ordinal);
+    }
+  }
+  index = std::move(new_index);
+  column_index_.Set(index);
+  return index;
+}
+
+const IColumn *ITable::FindColumn(size_t name_type,
+                                  const std::string &name) const {
+  const auto index = GetColumnIndex();
+  const auto& map = index->map_list[name_type];
+  const auto itr = map.find(MakeKey(name));
+  if (itr == map.cend()) {
+    return nullptr;
+  }
+  if (itr->second < column_list_.size()) {
+    const auto& column = column_list_[itr->second];
+    if (IEquals(name, ColumnName(column, name_type))) {
+      return &column;
+    }
+  }
+
+  // The column names have been changed after the index was built.
+  column_index_.Reset();
+  const auto find = std::ranges::find_if(column_list_,
+                                         [&] (const auto& column) {
+    return IEquals(name, ColumnName(column, name_type));
   });
-  return itr == column_list_.cend() ? GetColumnByDbName(name) : &(*itr);
+  return find == column_list_.cend() ? nullptr : &(*find);
+}
+
+const IColumn *ITable::GetColumnByName(const std::string &name) const {
+  const auto* column = FindColumn(kApplicationName, name);
+  return column == nullptr ? GetColumnByDbName(name) : column;
 }
 
 const IColumn *ITable::GetColumnByDbName(const std::string &name) const {
-   const auto itr = std::ranges::find_if(column_list_, [&] (const auto& column) {
-    return util::string::IEquals(name,column.DatabaseName());
-  });
-  return itr == column_list_.cend() ? GetColumnByBaseName(name) : &(*itr);
+  const auto* column = FindColumn(kDatabaseName, name);
+  return column == nullptr ? GetColumnByBaseName(name) : column;
 }
 
 const IColumn *ITable::GetColumnByBaseName(const std::string &name) const {
-  const auto itr = std::ranges::find_if(column_list_, [&](const auto &column) {
-    return util::string::IEquals(name, column.BaseName());
-  });
-  return itr == column_list_.cend() ? nullptr : &(*itr);
+  return FindColumn(kBaseName, name);
 }
 
 IColumn *ITable::GetColumnByBaseName(const std::string &name) {
-  auto itr = std::ranges::find_if(column_list_, [&] (const auto& column) {
-    return util::string::IEquals(name,column.BaseName());
-  });
-  return itr == column_list_.end() ? nullptr : &(*itr);
+  const auto* column = std::as_const(*this).GetColumnByBaseName(name);
+  // The caller may change the column names.
+  column_index_.Reset();
+  return const_cast<IColumn*>(column);
 }
 
 bool ITable::DeleteSubTable(int64_t application_id) {
@@ -173,11 +280,10 @@ bool ITable::DeleteSubTable(int64_t application_id) {
 }
 
 void ITable::DeleteColumn(const std::string &name) {
-  auto itr = std::ranges::find_if(column_list_, [&] (const auto& column) {
-    return util::string::IEquals(name,column.ApplicationName());
-  });
-  if (itr != column_list_.end()) {
-    column_list_.erase(itr);
+  const auto* column = FindColumn(kApplicationName, name);
+  if (column != nullptr) {
+    column_list_.erase(column_list_.begin() + (column - column_list_.data()));
+    column_index_.Reset();
   }
 }
 
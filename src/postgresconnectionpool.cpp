@@ -0,0 +1,242 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "postgresconnectionpool.h"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <util/logstream.h>
+
+using namespace util::log;
+
+namespace ods::detail {
+
+/** \brief Pool state that the leases reference.
+ *
+ * The leases hold a weak pointer to the state, so a lease that outlives
+ * the pool doesn't reference a deleted pool.
+ */
+struct PostgresPoolState {
+  struct IdleConnection {
+    std::unique_ptr<PostgresDb> database;
+    std::chrono::steady_clock::time_point last_used;
+  };
+
+  explicit PostgresPoolState(const std::string& info)
+  : connection_info(info) {
+  }
+
+  const std::string connection_info;
+  std::chrono::milliseconds health_check_interval = std::chrono::seconds(30);
+
+  std::mutex lock;
+  std::condition_variable condition;
+  std::vector<IdleConnection> idle_list;
+  size_t nof_connections = 0; ///< Number of created connections.
+
+  void Release(std::unique_ptr<PostgresDb> database);
+};
+
+void PostgresPoolState::Release(std::unique_ptr<PostgresDb> database) {
+  if (database) {
+    try {
+      if (database->InTransaction()) {
+        database->RollbackTransaction();
+      }
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Failed to end a pool transaction. Error: " << err.what()
+                  << ", Connection: " << connection_info;
+      database->Close(false);
+    }
+  }
+
+  std::lock_guard pool_lock(lock);
+  if (database && database->IsOpen()) {
+    idle_list.push_back({std::move(database),
+                         std::chrono::steady_clock::now()});
+  } else if (nof_connections > 0) {
+    --nof_connections;
+  }
+  condition.notify_all();
+}
+
+PostgresConnectionLease::PostgresConnectionLease(
+    std::weak_ptr<PostgresPoolState> pool,
+    std::unique_ptr<PostgresDb> database)
+: pool_(std::move(pool)),
+  database_(std::move(database)) {
+}
+
+PostgresConnectionLease::~PostgresConnectionLease() {
+  Release();
+}
+
+PostgresConnectionLease::PostgresConnectionLease(
+    PostgresConnectionLease &&lease) noexcept
+: pool_(std::move(lease.pool_)),
+  database_(std::move(lease.database_)) {
+  lease.pool_.reset();
+}
+
+PostgresConnectionLease &PostgresConnectionLease::operator=(
+    PostgresConnectionLease &&lease) noexcept {
+  if (this != &lease) {
+    Release();
+    pool_ = std::move(lease.pool_);
+    database_ = std::move(lease.database_);
+    lease.pool_.reset();
+  }
+  return *this;
+}
+
+void PostgresConnectionLease::Release() {
+  if (database_) {
+    if (auto pool = pool_.lock(); pool) {
+      pool->Release(std::move(database_));
+    } else {
+      // The pool is deleted, so there is nothing to give the connection to.
+      database_->Close(false);
+    }
+  }
+  database_.reset();
+  pool_.reset();
+}
+
+PostgresConnectionPool::PostgresConnectionPool(
+    const std::string &connection_info, size_t max_connections)
+: connection_info_(connection_info),
+  max_connections_(max_connections < 1 ? 1 : max_connections),
+  state_(std::make_shared<PostgresPoolState>(connection_info)) {
+}
+
+PostgresConnectionPool::~PostgresConnectionPool() {
+  Close();
+}
+
+void PostgresConnectionPool::HealthCheckInterval(
+    std::chrono::milliseconds interval) {
+  std::lock_guard lock(state_->lock);
+  state_->health_check_interval = interval;
+}
+
+std::chrono::milliseconds PostgresConnectionPool::HealthCheckInterval() const {
+  std::lock_guard lock(state_->lock);
+  return state_->health_check_interval;
+}
+
+PostgresConnectionLease PostgresConnectionPool::Acquire(
+    std::chrono::milliseconds timeout) {
+  auto& state = *state_;
+  std::unique_lock lock(state.lock);
+  const bool available = state.condition.wait_for(lock, timeout, [&] {
+    return !state.idle_list.empty() ||
+        state.nof_connections < max_connections_;
+  });
+  if (!available) {
+    LOG_ERROR() << "Timeout waiting for a connection. Connection: "
+                << connection_info_;
+    return {};
+  }
+
+  std::unique_ptr<PostgresDb> database;
+  bool test = false;
+  if (!state.idle_list.empty()) {
+    auto& idle = state.idle_list.back();
+    test = std::chrono::steady_clock::now() - idle.last_used
+        >= state.health_check_interval;
+    database = std::move(idle.database);
+    state.idle_list.pop_back();
+  } else {
+    ++state.nof_connections;
+  }
+
+  // Open or check the connection outside the lock.
+  lock.unlock();
+  bool connection_ok = false;
+  if (database) {
+    connection_ok = CheckConnection(*database, test);
+  } else {
+    database = OpenConnection();
+    connection_ok = static_cast<bool>(database);
+  }
+  if (!connection_ok) {
+    lock.lock();
+    --state.nof_connections;
+    state.condition.notify_one();
+    return {};
+  }
+  return {state_, std::move(database)};
+}
+
+void PostgresConnectionPool::Close() {
+  std::vector<PostgresPoolState::IdleConnection> close_list;
+  {
+    std::lock_guard lock(state_->lock);
+    state_->nof_connections -= state_->idle_list.size();
+    close_list = std::move(state_->idle_list);
+    state_->idle_list.clear();
+  }
+  for (auto& idle : close_list) {
+    idle.database->Close(false);
+  }
+  state_->condition.notify_all();
+}
+
+size_t PostgresConnectionPool::NofConnections() const {
+  std::lock_guard lock(state_->lock);
+  return state_->nof_connections;
+}
+
+std::unique_ptr<PostgresDb> PostgresConnectionPool::OpenConnection() const {
+  auto database = std::make_unique<PostgresDb>();
+  database->ConnectionInfo(connection_info_);
+  database->Persistent(true);
+  try {
+    if (!database->Open()) {
+      LOG_ERROR() << "Failed to open a pool connection. Connection: "
+                  << connection_info_;
+      return {};
+    }
+    // The Open() function starts a transaction. The connection should be
+    // idle until it is used.
+    database->CommitTransaction();
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to open a pool connection. Error: " << err.what()
+                << ", Connection: " << connection_info_;
+    return {};
+  }
+  return database;
+}
+
+bool PostgresConnectionPool::CheckConnection(PostgresDb &database,
+                                             bool test) const {
+  bool connection_ok = database.IsConnectionOk();
+  if (connection_ok && test) {
+    try {
+      database.ExecuteSql("SELECT 1");
+    } catch (const std::exception& ) {
+      connection_ok = false;
+    }
+  }
+  if (connection_ok) {
+    return true;
+  }
+
+  LOG_DEBUG() << "Reconnecting a pool connection. Connection: "
+              << connection_info_;
+  try {
+    if (!database.Reconnect()) {
+      return false;
+    }
+    database.CommitTransaction();
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to reconnect a pool connection. Error: "
+                << err.what() << ", Connection: " << connection_info_;
+    return false;
+  }
+  return true;
+}
+
+} // namespace ods::detail
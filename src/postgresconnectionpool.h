@@ -0,0 +1,109 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include "postgresdb.h"
+
+namespace ods::detail {
+
+struct PostgresPoolState;
+
+/** \brief Checked out connection from a Postgres connection pool.
+ *
+ * The lease gives back the connection to the pool when it goes out of scope.
+ * Any open transaction is rolled back at that point, so use a DatabaseGuard
+ * inside the lease scope to commit the changes. The lease may outlive its
+ * pool. The connection is then closed instead of given back.
+ */
+class PostgresConnectionLease final {
+public:
+  PostgresConnectionLease() = default;
+  PostgresConnectionLease(std::weak_ptr<PostgresPoolState> pool,
+                          std::unique_ptr<PostgresDb> database);
+  ~PostgresConnectionLease();
+
+  PostgresConnectionLease(PostgresConnectionLease&& lease) noexcept;
+  PostgresConnectionLease& operator = (PostgresConnectionLease&& lease) noexcept;
+  PostgresConnectionLease(const PostgresConnectionLease&) = delete;
+  PostgresConnectionLease& operator = (const PostgresConnectionLease&) = delete;
+
+  [[nodiscard]] PostgresDb& operator * () const { return *database_; }
+  [[nodiscard]] PostgresDb* operator -> () const {
+    return database_.get();
+  }
+  [[nodiscard]] explicit operator bool() const {
+    return static_cast<bool>(database_);
+  }
+
+  /** \brief Gives back the connection before the lease goes out of scope. */
+  void Release();
+private:
+  std::weak_ptr<PostgresPoolState> pool_; ///< Expires with the pool.
+  std::unique_ptr<PostgresDb> database_;
+};
+
+/** \brief Pool of connections to one Postgres database.
+ *
+ * A PostgresDb object wraps one connection and should only be used by one
+ * thread at the time. The pool hands out up to N connections, so several
+ * threads may query and write in parallel. Each connection has its own
+ * prepared statements.
+ *
+ * The connections are opened when they are first needed and are kept open
+ * until the pool is closed. A connection is checked when it is checked out.
+ * A broken connection is reconnected. A connection that has been idle
+ * longer than the health check interval, is also tested with a query as the
+ * server may have closed it.
+ */
+class PostgresConnectionPool final {
+public:
+  explicit PostgresConnectionPool(const std::string& connection_info,
+                                  size_t max_connections = 4);
+  ~PostgresConnectionPool();
+
+  PostgresConnectionPool() = delete;
+  PostgresConnectionPool(const PostgresConnectionPool&) = delete;
+  PostgresConnectionPool& operator = (const PostgresConnectionPool&) = delete;
+
+  [[nodiscard]] const std::string& ConnectionInfo() const {
+    return connection_info_;
+  }
+  [[nodiscard]] size_t MaxConnections() const { return max_connections_; }
+
+  /** \brief Idle time before a connection is tested. Default is 30 s. */
+  void HealthCheckInterval(std::chrono::milliseconds interval);
+  [[nodiscard]] std::chrono::milliseconds HealthCheckInterval() const;
+
+  /** \brief Returns a connection.
+   *
+   * Waits for a free connection if all are checked out.
+   * @param timeout Max wait time.
+   * @return A lease that may be empty if the wait timed out or the
+   * connection failed.
+   */
+  [[nodiscard]] PostgresConnectionLease Acquire(
+      std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+  /** \brief Closes all idle connections. */
+  void Close();
+
+  /** \brief Number of opened connections. */
+  [[nodiscard]] size_t NofConnections() const;
+
+private:
+  std::string connection_info_;
+  size_t max_connections_ = 4;
+
+  /** \brief Connection lists that are shared with the leases. */
+  std::shared_ptr<PostgresPoolState> state_;
+
+  [[nodiscard]] std::unique_ptr<PostgresDb> OpenConnection() const;
+  [[nodiscard]] bool CheckConnection(PostgresDb& database, bool test) const;
+};
+
+} // namespace ods::detail
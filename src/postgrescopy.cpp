@@ -0,0 +1,349 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "postgrescopy.h"
+#include <array>
+#include <bit>
+#include <charconv>
+#include <sstream>
+#include <stdexcept>
+#include <util/logstream.h>
+
+using namespace util::log;
+
+namespace {
+
+// The binary parameter values are in network byte order (big-endian).
+uint64_t FromBinary(const char* value, int length) {
+  uint64_t temp = 0;
+  for (int byte = 0; byte < length; ++byte) {
+    temp <<= 8;
+    temp |= static_cast<uint8_t>(value[byte]);
+  }
+  return temp;
+}
+
+template <typename T>
+void AppendNumber(T value, std::string& line) {
+  std::array<char, 32> text {};
+  const auto [end, ec] = std::to_chars(text.data(),
+                                       text.data() + text.size(), value);
+  line.append(text.data(), ec == std::errc() ? end : text.data());
+}
+
+void AppendBinary(ods::detail::PostgresType type, const char* value,
+                  int length, std::string& line) {
+  using ods::detail::PostgresType;
+  const uint64_t bits = FromBinary(value, length);
+  switch (type) {
+    case PostgresType::SmallInt:
+      AppendNumber(static_cast<int16_t>(bits), line);
+      break;
+
+    case PostgresType::Integer:
+      AppendNumber(static_cast<int32_t>(bits), line);
+      break;
+
+    case PostgresType::BigInt:
+      AppendNumber(static_cast<int64_t>(bits), line);
+      break;
+
+    case PostgresType::Real:
+      AppendNumber(std::bit_cast<float>(static_cast<uint32_t>(bits)), line);
+      break;
+
+    case PostgresType::Double:
+      AppendNumber(std::bit_cast<double>(bits), line);
+      break;
+
+    case PostgresType::Boolean:
+      line.push_back(bits != 0 ? 't' : 'f');
+      break;
+
+    case PostgresType::ByteArray: {
+      // The bytea hex format (\x0102) with an escaped backslash.
+      constexpr std::string_view kHex = "0123456789abcdef";
+      line.append("\\\\x");
+      for (int byte = 0; byte < length; ++byte) {
+        const auto data = static_cast<uint8_t>(value[byte]);
+        line.push_back(kHex[data >> 4]);
+        line.push_back(kHex[data & 0x0F]);
+      }
+      break;
+    }
+
+    default:
+      throw std::runtime_error("Unsupported binary COPY value");
+  }
+}
+
+} // end namespace
+
+namespace ods::detail {
+
+PostgresCopy::PostgresCopy(PGconn *connection)
+: connection_(connection) {
+}
+
+PostgresCopy::~PostgresCopy() {
+  if (active_) {
+    try {
+      Abort("Copy not completed");
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Abort of COPY failed. Error: " << err.what();
+    }
+  }
+}
+
+std::string PostgresCopy::ConnectionError() const {
+  const auto* msg = connection_ != nullptr ?
+      PQerrorMessage(connection_) : nullptr;
+  return msg != nullptr ? msg : "Unknown error";
+}
+
+void PostgresCopy::Start(const std::string &sql) {
+  if (connection_ == nullptr) {
+    throw std::runtime_error("Database not open");
+  }
+  if (active_) {
+    throw std::runtime_error("A COPY command is already active");
+  }
+  auto* result = PQexec(connection_, sql.c_str());
+  const auto status = PQresultStatus(result);
+  if (status != PGRES_COPY_IN && status != PGRES_COPY_OUT) {
+    const auto* msg = PQresultErrorMessage(result);
+    std::ostringstream err;
+    err << "COPY command failed. Error: "
+        << (msg != nullptr ? msg : "Bad response") << ", SQL: " << sql;
+    PQclear(result);
+    throw std::runtime_error(err.str());
+  }
+  PQclear(result);
+  sql_ = sql;
+  buffer_.clear();
+  buffer_.reserve(kChunkSize + 1024);
+  nof_rows_ = 0;
+  copy_out_ = status == PGRES_COPY_OUT;
+  active_ = true;
+}
+
+void PostgresCopy::AppendText(std::string_view text, std::string &line) {
+  for (const char input : text) {
+    switch (input) {
+      case '\\':
+        line.append("\\\\");
+        break;
+
+      case '\t':
+        line.append("\\t");
+        break;
+
+      case '\n':
+        line.append("\\n");
+        break;
+
+      case '\r':
+        line.append("\\r");
+        break;
+
+      default:
+        line.push_back(input);
+        break;
+    }
+  }
+}
+
+std::string PostgresCopy::MakeLine(const PostgresParameters &row) {
+  const auto* value_list = row.Values();
+  const auto* length_list = row.Lengths();
+  const auto* format_list = row.Formats();
+
+  std::string line;
+  for (int index = 0; index < row.Size(); ++index) {
+    if (index > 0) {
+      line.push_back('\t');
+    }
+    if (row.IsNull(index)) {
+      line.append("\\N");
+    } else if (format_list[index] == 1) {
+      AppendBinary(row.Type(index), value_list[index], length_list[index],
+                   line);
+    } else {
+      AppendText(std::string_view(value_list[index], length_list[index]),
+                 line);
+    }
+  }
+  line.push_back('\n');
+  return line;
+}
+
+void PostgresCopy::SplitLine(std::string_view line,
+                             std::vector<std::string_view> &value_list) {
+  value_list.clear();
+  for (size_t start = 0; start <= line.size(); ) {
+    const auto tab = line.find('\t', start);
+    if (tab == std::string_view::npos) {
+      value_list.push_back(line.substr(start));
+      break;
+    }
+    value_list.push_back(line.substr(start, tab - start));
+    start = tab + 1;
+  }
+}
+
+std::string PostgresCopy::FromText(std::string_view text) {
+  std::string value;
+  value.reserve(text.size());
+  for (size_t index = 0; index < text.size(); ++index) {
+    const char input = text[index];
+    if (input != '\\' || index + 1 >= text.size()) {
+      value.push_back(input);
+      continue;
+    }
+    const char escape = text[++index];
+    switch (escape) {
+      case 'b': value.push_back('\b'); break;
+      case 'f': value.push_back('\f'); break;
+      case 'n': value.push_back('\n'); break;
+      case 'r': value.push_back('\r'); break;
+      case 't': value.push_back('\t'); break;
+      case 'v': value.push_back('\v'); break;
+      default: value.push_back(escape); break;
+    }
+  }
+  return value;
+}
+
+void PostgresCopy::AddRow(const PostgresParameters &row) {
+  if (!active_ || copy_out_) {
+    throw std::runtime_error("The COPY command is not started");
+  }
+  buffer_.append(MakeLine(row));
+  ++nof_rows_;
+  if (buffer_.size() >= kChunkSize) {
+    Flush();
+  }
+}
+
+void PostgresCopy::Flush() {
+  if (buffer_.empty()) {
+    return;
+  }
+  const auto send = PQputCopyData(connection_, buffer_.data(),
+                                  static_cast<int>(buffer_.size()));
+  if (send != 1) {
+    std::ostringstream err;
+    err << "Sending COPY data failed. Error: " << ConnectionError()
+        << ", SQL: " << sql_;
+    throw std::runtime_error(err.str());
+  }
+  buffer_.clear();
+}
+
+size_t PostgresCopy::End() {
+  if (!active_) {
+    return nof_rows_;
+  }
+  if (copy_out_) {
+    // Reads and skips the remaining rows.
+    for (std::string line; GetLine(line); ) {
+    }
+    return nof_rows_;
+  }
+  Flush();
+  active_ = false;
+  if (PQputCopyEnd(connection_, nullptr) != 1) {
+    std::ostringstream err;
+    err << "Ending COPY failed. Error: " << ConnectionError()
+        << ", SQL: " << sql_;
+    throw std::runtime_error(err.str());
+  }
+  return GetResult();
+}
+
+bool PostgresCopy::GetLine(std::string &line) {
+  if (!active_ || !copy_out_) {
+    return false;
+  }
+  char* buffer = nullptr;
+  const auto size = PQgetCopyData(connection_, &buffer, 0);
+  if (size > 0 && buffer != nullptr) {
+    // Each call returns one row including the newline.
+    const auto length = buffer[size - 1] == '\n' ? size - 1 : size;
+    line.assign(buffer, length);
+    PQfreemem(buffer);
+    ++nof_rows_;
+    return true;
+  }
+  if (buffer != nullptr) {
+    PQfreemem(buffer);
+  }
+  active_ = false;
+  if (size == -2) {
+    std::ostringstream err;
+    err << "Reading COPY data failed. Error: " << ConnectionError()
+        << ", SQL: " << sql_;
+    throw std::runtime_error(err.str());
+  }
+  GetResult();
+  return false;
+}
+
+size_t PostgresCopy::GetResult() {
+  // The result of the COPY command is returned after the end of data.
+  std::string error;
+  size_t nof_rows = 0;
+  for (auto* result = PQgetResult(connection_); result != nullptr;
+       result = PQgetResult(connection_)) {
+    if (PQresultStatus(result) == PGRES_COMMAND_OK) {
+      const auto* tuples = PQcmdTuples(result);
+      nof_rows = tuples != nullptr && *tuples != '\0' ?
+          std::stoull(tuples) : nof_rows_;
+    } else if (error.empty()) {
+      const auto* msg = PQresultErrorMessage(result);
+      error = msg != nullptr ? msg : "Bad response";
+    }
+    PQclear(result);
+  }
+  if (!error.empty()) {
+    std::ostringstream err;
+    err << "COPY failed. Error: " << error << ", SQL: " << sql_;
+    throw std::runtime_error(err.str());
+  }
+  return nof_rows;
+}
+
+void PostgresCopy::Abort(const std::string &reason) {
+  if (!active_) {
+    return;
+  }
+  active_ = false;
+  buffer_.clear();
+  if (copy_out_) {
+    // The server stops sending when the command is cancelled.
+    if (auto* cancel = PQgetCancel(connection_); cancel != nullptr) {
+      std::array<char, 256> error {};
+      PQcancel(cancel, error.data(), static_cast<int>(error.size()));
+      PQfreeCancel(cancel);
+    }
+    char* buffer = nullptr;
+    while (PQgetCopyData(connection_, &buffer, 0) > 0) {
+      PQfreemem(buffer);
+      buffer = nullptr;
+    }
+    if (buffer != nullptr) {
+      PQfreemem(buffer);
+    }
+  } else {
+    PQputCopyEnd(connection_, reason.c_str());
+  }
+  // The server returns an error result, which is expected.
+  for (auto* result = PQgetResult(connection_); result != nullptr;
+       result = PQgetResult(connection_)) {
+    PQclear(result);
+  }
+}
+
+} // namespace ods::detail
@@ -0,0 +1,101 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <libpq-fe.h>
+#include "postgresparameters.h"
+
+namespace ods::detail {
+
+/** \brief Streams rows with the COPY FROM STDIN and COPY TO STDOUT commands.
+ *
+ * The COPY command is much faster than INSERT and SELECT when many rows
+ * shall be transferred, as all rows are sent in one stream without any
+ * round-trips to the server. The rows are sent in the text format, one line
+ * per row with tab separated values.
+ *
+ * When copying into a table, the rows are buffered and sent in chunks. The
+ * End() function must be called to complete the command. The destructor
+ * aborts the command if it wasn't ended, which means that none of the rows
+ * are inserted.
+ *
+ * When copying from a table, the rows are read one by one with the
+ * GetLine() function until it returns false.
+ */
+class PostgresCopy final {
+public:
+  static constexpr size_t kChunkSize = 64 * 1024; ///< Bytes per send.
+
+  explicit PostgresCopy(PGconn* connection);
+  ~PostgresCopy();
+
+  PostgresCopy(const PostgresCopy&) = delete;
+  PostgresCopy& operator = (const PostgresCopy&) = delete;
+
+  /** \brief Sends the COPY ... FROM STDIN or COPY ... TO STDOUT command.
+   *
+   * The function throws if the server doesn't accept the command.
+   * @param sql COPY command.
+   */
+  void Start(const std::string& sql);
+
+  /** \brief Adds a row. Each parameter is a column value. */
+  void AddRow(const PostgresParameters& row);
+
+  /** \brief Sends the last rows and completes the command.
+   *
+   * The function throws if the server fails to insert the rows.
+   * @return Number of inserted rows.
+   */
+  size_t End();
+
+  /** \brief Reads the next row from a COPY TO STDOUT command.
+   *
+   * The function throws if the server fails to send the rows.
+   * @param line The row without the ending newline.
+   * @return False when there are no more rows.
+   */
+  bool GetLine(std::string& line);
+
+  /** \brief Aborts the command. No rows are inserted. */
+  void Abort(const std::string& reason);
+
+  [[nodiscard]] bool IsActive() const { return active_; }
+  [[nodiscard]] size_t NofRows() const { return nof_rows_; }
+
+  /** \brief Returns a row as a COPY text line including the newline. */
+  [[nodiscard]] static std::string MakeLine(const PostgresParameters& row);
+
+  /** \brief Appends text with the COPY escape sequences. */
+  static void AppendText(std::string_view text, std::string& line);
+
+  /** \brief Splits a row into its tab separated values.
+   *
+   * The values are views into the line, so the line must be kept while the
+   * values are used. A NULL value is returned as "\N".
+   */
+  static void SplitLine(std::string_view line,
+                        std::vector<std::string_view>& value_list);
+
+  /** \brief Returns a value without the COPY escape sequences. */
+  [[nodiscard]] static std::string FromText(std::string_view text);
+private:
+  PGconn* connection_ = nullptr;
+  std::string buffer_;
+  std::string sql_;
+  bool active_ = false;
+  bool copy_out_ = false; ///< True if COPY TO STDOUT.
+  size_t nof_rows_ = 0;
+
+  void Flush();
+  size_t GetResult();
+  [[nodiscard]] std::string ConnectionError() const;
+};
+
+} // namespace ods::detail
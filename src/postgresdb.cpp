@@ -5,18 +5,365 @@
 
 #include "postgresdb.h"
 #include "postgresstatement.h"
+#include "postgrescopy.h"
+#include <array>
+#include <cctype>
+#include <charconv>
 #include <exception>
+#include <fstream>
+#include <util/csvwriter.h>
 #include <util/logstream.h>
 #include <util/utilfactory.h>
 #include <util/stringutil.h>
 #include <util/timestamp.h>
 #include <sqlite3.h>
 #include "ods/baseattribute.h"
+#include "ods/databaseguard.h"
+#include "odshelper.h"
 
 using namespace util::log;
 using namespace util::string;
 using namespace util::time;
 
+namespace {
+
+int64_t HandleResult(PGresult* result, const std::string& sql) {
+  int64_t ret_val = 0;
+  const auto status = PQresultStatus(result);
+  switch (status) {
+    case PGRES_EMPTY_QUERY:
+    case PGRES_FATAL_ERROR:
+    case PGRES_NONFATAL_ERROR:
+    case PGRES_BAD_RESPONSE: {
+      const auto *msg = PQresultErrorMessage(result);
+
+      std::string error = msg != nullptr ? msg : "Bad response";
+      std::ostringstream err;
+      err << "Bad response on SQL. Error: " << error << ", SQL: " << sql;
+      LOG_ERROR() << err.str();
+      PQclear(result);
+      throw std::runtime_error(err.str());
+    }
+
+    case PGRES_SINGLE_TUPLE:
+    case PGRES_TUPLES_OK:
+      if (result != nullptr) {
+        const auto rows = PQntuples(result); // Should return 1
+        const auto columns = PQnfields(result);
+        if (columns > 0 && rows > 0) {
+          const auto* value = PQgetvalue(result, 0,0);
+          if (value != nullptr) {
+            try {
+              ret_val = std::stoll(value);
+            } catch(const std::exception&) {}
+          }
+        }
+      }
+      break;
+
+    default:
+      break;
+
+  }
+  PQclear(result);
+  return ret_val;
+}
+
+using ods::detail::PostgresType;
+
+/** \brief Number of statements between the syncs in pipeline mode. */
+constexpr size_t kPipelineSize = 256;
+
+PostgresType ColumnType(const ods::IColumn& column) {
+  // Same types as the DataTypeToDbString() function returns.
+  using namespace ods;
+  switch (column.DataType()) {
+    case DataType::DtShort:
+    case DataType::DtByte:
+      return PostgresType::SmallInt;
+
+    case DataType::DtBoolean:
+      return PostgresType::Boolean;
+
+    case DataType::DtEnum:
+    case DataType::DtLong:
+      return PostgresType::Integer;
+
+    case DataType::DtId:
+    case DataType::DtLongLong:
+      return PostgresType::BigInt;
+
+    case DataType::DtDouble:
+      return PostgresType::Double;
+
+    case DataType::DtFloat:
+      return PostgresType::Real;
+
+    case DataType::DtByteString:
+    case DataType::DtBlob:
+      return PostgresType::ByteArray;
+
+    case DataType::DtDate:
+      return PostgresType::TimestampTz;
+
+    case DataType::DtExternalRef:
+    case DataType::DtString:
+      return PostgresType::Varchar;
+
+    default:
+      break;
+  }
+  return PostgresType::Unknown;
+}
+
+void AddDateParameter(const std::string& date_value,
+                      ods::detail::PostgresParameters& parameters) {
+  // The MakeDateValue() function returns 'time' or NULL.
+  if (date_value.size() < 2 || date_value.front() != '\'') {
+    parameters.AddNull(PostgresType::TimestampTz);
+  } else {
+    parameters.AddText(date_value.substr(1, date_value.size() - 2),
+                       PostgresType::TimestampTz);
+  }
+}
+
+/** \brief Adds a value with the column type.
+ *
+ * Integer, float and boolean columns gets binary values. Other columns gets
+ * the text value. Any value is converted from its text value if the column
+ * type is unknown.
+ */
+void AddColumnParameter(const ods::IColumn& column,
+                        const ods::IAttribute& attr,
+                        ods::detail::PostgresParameters& parameters) {
+  const auto type = ColumnType(column);
+  switch (type) {
+    case PostgresType::SmallInt:
+    case PostgresType::Integer:
+    case PostgresType::BigInt:
+      parameters.AddInteger(attr.Value<int64_t>(), type);
+      break;
+
+    case PostgresType::Real:
+    case PostgresType::Double:
+      parameters.AddFloat(attr.Value<double>(), type);
+      break;
+
+    case PostgresType::Boolean:
+      parameters.AddBoolean(attr.Value<bool>());
+      break;
+
+    case PostgresType::ByteArray:
+      parameters.AddBytes(ods::OdsHelper::FromBase64(
+          attr.Value<std::string>()));
+      break;
+
+    default:
+      parameters.AddText(attr.Value<std::string>(), type);
+      break;
+  }
+}
+
+/** \brief Returns the WHERE statement with the filter values as parameters.
+ *
+ * The parameter numbers continue after the existing parameters.
+ */
+std::string MakeWhereSql(const ods::SqlFilter& filter,
+                         ods::detail::PostgresParameters& parameters) {
+  std::vector<std::string> value_list(parameters.Size());
+  auto where = filter.GetWhereStatement(value_list, '$');
+  for (size_t index = parameters.Size(); index < value_list.size(); ++index) {
+    // The server decides the type from the column.
+    parameters.AddText(value_list[index]);
+  }
+  return where;
+}
+
+/** \brief Returns the COPY TO STDOUT command for the columns.
+ *
+ * A filter needs a SELECT statement while a full table is copied directly.
+ * The COPY command cannot have any parameters, so the filter values are
+ * in the SQL text.
+ */
+std::string MakeCopyOutSql(const ods::ITable& table,
+                           const std::vector<const ods::IColumn*>& column_list,
+                           const ods::SqlFilter& filter) {
+  std::ostringstream columns;
+  for (const auto* column : column_list) {
+    if (column != column_list.front()) {
+      columns << ",";
+    }
+    columns << column->DatabaseName();
+  }
+
+  std::ostringstream copy;
+  if (filter.IsEmpty()) {
+    copy << "COPY " << table.DatabaseName() << " (" << columns.str() << ")";
+  } else {
+    copy << "COPY (SELECT " << columns.str() << " FROM "
+         << table.DatabaseName() << " " << filter.GetWhereStatement() << ")";
+  }
+  copy << " TO STDOUT";
+  return copy.str();
+}
+
+/** \brief Converts a COPY text value to a dump file value.
+ *
+ * Same format as the IDatabase::DumpRow() function creates.
+ */
+void AppendDumpValue(const ods::IColumn& column, std::string_view copy_value,
+                     std::ostream& out_file) {
+  using namespace ods;
+  const bool null_value = copy_value == "\\N";
+  if ((null_value || copy_value.empty())
+      && !column.Obligatory() && !column.Unique()) {
+    out_file << "~NULL~";
+    return;
+  }
+  const std::string value = null_value ?
+      std::string() : ods::detail::PostgresCopy::FromText(copy_value);
+
+  switch (column.DataType()) {
+    case DataType::DtBoolean:
+      out_file << (!value.empty() && value[0] == 't' ? 1 : 0);
+      break;
+
+    case DataType::DtBlob:
+      // The bytea hex format is \x0102.
+      for (size_t index = 2; index < value.size(); ++index) {
+        out_file << static_cast<char>(std::toupper(value[index]));
+      }
+      break;
+
+    case DataType::DtByte:
+    case DataType::DtEnum:
+    case DataType::DtLongLong:
+    case DataType::DtLong:
+    case DataType::DtShort:
+      out_file << (value.empty() ? "0" : value);
+      break;
+
+    case DataType::DtDouble:
+    case DataType::DtFloat: {
+      double number = 0.0;
+      std::from_chars(value.data(), value.data() + value.size(), number);
+      char temp[40] = {'\0'};
+      std::to_chars(temp, temp + 38, number);
+      out_file << temp;
+      break;
+    }
+
+    case DataType::DtDate: {
+      const uint64_t ns1970 = IsoTimeToNs(value, false);
+      int format = 0;
+      if (ns1970 % 1'000 != 0) {
+        format = 3;
+      } else if (ns1970 % 1'000'000 != 0) {
+        format = 2;
+      } else if (ns1970 % 1'000'000'000 != 0) {
+        format = 1;
+      }
+      out_file << NsToIsoTime(ns1970, format);
+      break;
+    }
+
+    default:
+      out_file << OdsHelper::ConvertToDumpString(value);
+      break;
+  }
+}
+
+template <typename T>
+T CopyNumber(std::string_view copy_value) {
+  T number {};
+  std::from_chars(copy_value.data(), copy_value.data() + copy_value.size(),
+                  number);
+  return number;
+}
+
+/** \brief Table column and its result column index. */
+struct ResultBinding {
+  const ods::IColumn* column = nullptr;
+  int index = -1;
+};
+
+std::vector<ResultBinding> MakeResultBindings(const ods::ITable& table,
+                                const ods::detail::PostgresStatement& select) {
+  std::vector<ResultBinding> binding_list;
+  const auto& column_list = table.Columns();
+  binding_list.reserve(column_list.size());
+  for (const auto& column : column_list) {
+    if (column.DatabaseName().empty()) {
+      continue;
+    }
+    const auto index = select.GetColumnIndex(column.DatabaseName());
+    if (index >= 0) {
+      binding_list.push_back({&column, index});
+    }
+  }
+  return binding_list;
+}
+
+/** \brief Adds the result values to the row.
+ *
+ * Binary values are decoded by the column type without any text parsing.
+ * NULL values are added as empty values, same as in the text format.
+ */
+void AddResultAttributes(const std::vector<ResultBinding>& binding_list,
+                         const ods::detail::PostgresStatement& select,
+                         ods::IItem& row) {
+  using namespace ods;
+  row.AttributeList().reserve(binding_list.size());
+  for (const auto& binding : binding_list) {
+    const auto& column = *binding.column;
+    const auto index = binding.index;
+    if (!select.IsBinary(index)) {
+      row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                           select.Value<std::string>(index)});
+      continue;
+    }
+    if (select.IsNull(index)) {
+      row.AppendAttribute({column.ApplicationName(), column.BaseName(), ""});
+      continue;
+    }
+    switch (column.DataType()) {
+      case DataType::DtEnum:
+      case DataType::DtId:
+      case DataType::DtLongLong:
+      case DataType::DtLong:
+      case DataType::DtByte:
+      case DataType::DtShort:
+        row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                             select.Value<int64_t>(index)});
+        break;
+
+      case DataType::DtDouble:
+      case DataType::DtFloat:
+        row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                             select.Value<double>(index)});
+        break;
+
+      case DataType::DtBoolean:
+        row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                             select.Value<bool>(index)});
+        break;
+
+      case DataType::DtBlob:
+      case DataType::DtByteString:
+        row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                             select.Value<std::vector<uint8_t>>(index)});
+        break;
+
+      default:
+        row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                             select.Value<std::string>(index)});
+        break;
+    }
+  }
+}
+
+} // end namespace
+
 namespace ods::detail {
 
 PostgresDb::PostgresDb()
@@ -62,10 +409,8 @@ bool PostgresDb::Open() {
   if (IsOpen()) {
     return true;
   }
-  if (connection_ != nullptr) {
-    PQfinish(connection_);
-    connection_ = nullptr;
-  }
+  CloseConnection();
+  statement_cache_.Clear();
   connection_ = PQconnectdb(ConnectionInfo().c_str());
   const auto status = PQstatus(connection_);
   if (status != CONNECTION_OK) {
@@ -77,10 +422,18 @@ bool PostgresDb::Open() {
     connection_ = nullptr;
     return false;
   }
+  {
+    std::lock_guard lock(cancel_lock_);
+    cancel_ = PQgetCancel(connection_);
+  }
   if (listen_ && listen_->IsActive()) {
     // Todo Add listen connect info
   }
   try {
+    // The setting is done outside the transaction, so it lasts the session.
+    if (query_timeout_.count() > 0) {
+      ApplyQueryTimeout();
+    }
     ExecuteSql("BEGIN");
   } catch (const std::exception& err) {
     return false;
@@ -92,19 +445,82 @@ bool PostgresDb::IsOpen() const {
     return connection_ != nullptr;
 }
 
+bool PostgresDb::InTransaction() const {
+  if (connection_ == nullptr) {
+    return false;
+  }
+  const auto status = PQtransactionStatus(connection_);
+  return status == PQTRANS_INTRANS || status == PQTRANS_INERROR
+    || status == PQTRANS_ACTIVE;
+}
+
+bool PostgresDb::IsConnectionOk() const {
+  return connection_ != nullptr && PQstatus(connection_) == CONNECTION_OK;
+}
+
+bool PostgresDb::Reconnect() {
+  if (connection_ != nullptr) {
+    // The connection is broken, so there is no transaction to end.
+    statement_cache_.Clear();
+    CloseConnection();
+  }
+  return Open();
+}
+
+void PostgresDb::CloseConnection() {
+  {
+    std::lock_guard lock(cancel_lock_);
+    if (cancel_ != nullptr) {
+      PQfreeCancel(cancel_);
+      cancel_ = nullptr;
+    }
+  }
+  if (connection_ != nullptr) {
+    PQfinish(connection_);
+    connection_ = nullptr;
+  }
+}
+
+void PostgresDb::QueryTimeout(std::chrono::milliseconds timeout) {
+  IDatabase::QueryTimeout(timeout);
+  if (IsOpen()) {
+    ApplyQueryTimeout();
+  }
+}
+
+void PostgresDb::ApplyQueryTimeout() {
+  // A zero value disables the timeout.
+  std::ostringstream sql;
+  sql << "SET statement_timeout = " << query_timeout_.count();
+  ExecuteSql(sql.str());
+}
+
+void PostgresDb::Interrupt() {
+  std::lock_guard lock(cancel_lock_);
+  if (cancel_ == nullptr) {
+    return;
+  }
+  std::array<char, 256> error {};
+  if (PQcancel(cancel_, error.data(), static_cast<int>(error.size())) == 0) {
+    LOG_ERROR() << "Failed to cancel the query. Error: " << error.data();
+  }
+}
+
 bool PostgresDb::Close(bool commit) {
   if (!IsOpen()) {
     return true;
   }
   bool close = false;
   try {
-    ExecuteSql(commit ? "COMMIT" : "ROLLBACK");
+    if (InTransaction()) {
+      ExecuteSql(commit ? "COMMIT" : "ROLLBACK");
+    }
     close = true;
   } catch (const std::exception& error) {
     LOG_ERROR() << "Ending transaction failed. Error:" << error.what();
   }
-  PQfinish(connection_);
-  connection_ = nullptr;
+  statement_cache_.Clear();
+  CloseConnection();
   return close;
 }
 
@@ -112,46 +528,566 @@ int64_t PostgresDb::ExecuteSql(const std::string &sql) {
   if (!IsOpen()) {
     throw std::runtime_error("Database not open");
   }
-  int64_t ret_val = 0;
-  auto *result = PQexec(connection_, sql.c_str());
-  const auto status = PQresultStatus(result);
-  switch (status) {
-    case PGRES_EMPTY_QUERY:
-    case PGRES_FATAL_ERROR:
-    case PGRES_NONFATAL_ERROR:
-    case PGRES_BAD_RESPONSE: {
-      const auto *msg = PQresultErrorMessage(result);
+  return HandleResult(PQexec(connection_, sql.c_str()), sql);
+}
 
-      std::string error = msg != nullptr ? msg : "Bad response";
+int64_t PostgresDb::ExecuteParameters(const std::string &sql,
+                                      const PostgresParameters &parameters,
+                                      bool prepare) {
+  if (!IsOpen()) {
+    throw std::runtime_error("Database not open");
+  }
+  PGresult* result = nullptr;
+  if (prepare) {
+    const auto name = statement_cache_.Prepare(connection_, sql,
+                                               parameters.Size(),
+                                               parameters.Types());
+    result = PQexecPrepared(connection_, name.c_str(), parameters.Size(),
+                            parameters.Values(), parameters.Lengths(),
+                            parameters.Formats(), 0);
+  } else {
+    result = PQexecParams(connection_, sql.c_str(), parameters.Size(),
+                          parameters.Types(), parameters.Values(),
+                          parameters.Lengths(), parameters.Formats(), 0);
+  }
+  return HandleResult(result, sql);
+}
+
+std::vector<int64_t> PostgresDb::ExecutePipeline(
+    const std::vector<PipelineStatement> &statement_list, bool prepare) {
+  if (!IsOpen()) {
+    throw std::runtime_error("Database not open");
+  }
+  std::vector<int64_t> result_list;
+  result_list.reserve(statement_list.size());
+
+  // The results are read after each sync. The server stops if the results
+  // are not read, so a sync is sent after a limited number of statements.
+  for (size_t first = 0; first < statement_list.size();
+       first += kPipelineSize) {
+    const size_t last = std::min(first + kPipelineSize, statement_list.size());
+
+    // Statements cannot be prepared in pipeline mode.
+    std::vector<std::string> name_list;
+    if (prepare) {
+      for (size_t index = first; index < last; ++index) {
+        const auto& statement = statement_list[index];
+        name_list.push_back(statement_cache_.Prepare(connection_,
+                                      statement.sql,
+                                      statement.parameters.Size(),
+                                      statement.parameters.Types()));
+      }
+    }
+
+    if (PQenterPipelineMode(connection_) != 1) {
       std::ostringstream err;
-      err << "Bad response on SQL. Error: " << error << ", SQL: " << sql;
+      err << "Failed to enter pipeline mode. Error: "
+          << PQerrorMessage(connection_);
+      throw std::runtime_error(err.str());
+    }
+
+    std::string error;
+    size_t nof_sent = 0;
+    for (size_t index = first; index < last; ++index) {
+      const auto& statement = statement_list[index];
+      const auto& parameters = statement.parameters;
+      const int send = prepare ?
+          PQsendQueryPrepared(connection_, name_list[index - first].c_str(),
+                              parameters.Size(), parameters.Values(),
+                              parameters.Lengths(), parameters.Formats(), 0) :
+          PQsendQueryParams(connection_, statement.sql.c_str(),
+                            parameters.Size(), parameters.Types(),
+                            parameters.Values(), parameters.Lengths(),
+                            parameters.Formats(), 0);
+      if (send != 1) {
+        std::ostringstream err;
+        err << PQerrorMessage(connection_) << ", SQL: " << statement.sql;
+        error = err.str();
+        break;
+      }
+      ++nof_sent;
+    }
+    PQpipelineSync(connection_);
+
+    // Each statement has its result followed by a null result. A failing
+    // statement aborts the remaining statements in the pipeline.
+    for (size_t index = 0; index < nof_sent; ++index) {
+      int64_t value = 0;
+      for (auto* result = PQgetResult(connection_); result != nullptr;
+           result = PQgetResult(connection_)) {
+        const auto status = PQresultStatus(result);
+        if (status == PGRES_TUPLES_OK && PQntuples(result) > 0
+            && PQnfields(result) > 0) {
+          const auto* text = PQgetvalue(result, 0, 0);
+          try {
+            value = text != nullptr ? std::stoll(text) : 0;
+          } catch (const std::exception&) {}
+        } else if (status != PGRES_COMMAND_OK && status != PGRES_TUPLES_OK
+                   && error.empty()) {
+          const auto* msg = PQresultErrorMessage(result);
+          std::ostringstream err;
+          err << (msg != nullptr ? msg : "Bad response") << ", SQL: "
+              << statement_list[first + index].sql;
+          error = err.str();
+        }
+        PQclear(result);
+      }
+      result_list.push_back(value);
+    }
+    auto* sync = PQgetResult(connection_);
+    PQclear(sync);
+    PQexitPipelineMode(connection_);
+
+    if (!error.empty()) {
+      std::ostringstream err;
+      err << "Pipeline failed. Error: " << error;
       LOG_ERROR() << err.str();
-      PQclear(result);
       throw std::runtime_error(err.str());
     }
+  }
+  return result_list;
+}
 
-    case PGRES_SINGLE_TUPLE:
-    case PGRES_TUPLES_OK:
-      if (result != nullptr) {
-        const auto rows = PQntuples(result); // Should return 1
-        const auto columns = PQnfields(result);
-        if (columns > 0 && rows > 0) {
-          const auto* value = PQgetvalue(result, 0,0);
-          if (value != nullptr) {
-            try {
-              ret_val = std::stoll(value);
-            } catch(const std::exception&) {}
+void PostgresDb::Insert(const ITable &table, IItem &row,
+                        const SqlFilter &filter) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+
+  const auto &column_list = table.Columns();
+  const auto* column_id = table.GetColumnByBaseName("id");
+  if (table.DatabaseName().empty() || column_list.empty() || column_id == nullptr) {
+    return;
+  }
+
+  // The SQL text is the same for all rows in a table, so it is prepared once.
+  const TableLayout layout(table);
+  PostgresParameters parameters;
+  BindInsertValues(layout, row, parameters);
+  const auto idx = ExecuteParameters(MakeInsertSql(table), parameters, true);
+  row.ItemId(idx);
+}
+
+std::vector<int64_t> PostgresDb::InsertBatch(const ITable &table,
+                                             std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+  std::vector<int64_t> index_list;
+  const auto* column_id = table.GetColumnByBaseName("id");
+  if (table.DatabaseName().empty() || table.Columns().empty()
+      || column_id == nullptr || row_list.empty()) {
+    return index_list;
+  }
+
+  const auto sql = MakeInsertSql(table);
+  const TableLayout layout(table);
+  std::vector<PipelineStatement> statement_list(row_list.size());
+  for (size_t index = 0; index < row_list.size(); ++index) {
+    statement_list[index].sql = sql;
+    BindInsertValues(layout, row_list[index], statement_list[index].parameters);
+  }
+
+  // The save point makes it possible to roll back the batch only.
+  ExecuteSql("SAVEPOINT insert_batch");
+  try {
+    index_list = ExecutePipeline(statement_list, true);
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT insert_batch");
+    ExecuteSql("RELEASE SAVEPOINT insert_batch");
+    throw;
+  }
+  ExecuteSql("RELEASE SAVEPOINT insert_batch");
+
+  for (size_t index = 0; index < row_list.size(); ++index) {
+    row_list[index].ItemId(index_list[index]);
+  }
+  return index_list;
+}
+
+std::string PostgresDb::MakeInsertSql(const ITable &table) {
+  const auto* column_id = table.GetColumnByBaseName("id");
+  std::ostringstream insert;
+  std::ostringstream values;
+  insert << "INSERT INTO " << table.DatabaseName() << " (";
+  int column_count = 1;
+  for (const auto &col: table.Columns()) {
+    if (IEquals(col.BaseName(), "id") || col.DatabaseName().empty()) {
+      continue;
+    }
+    if (column_count > 1) {
+      insert << ",";
+      values << ",";
+    }
+    insert << col.DatabaseName();
+    values << "$" << column_count;
+    ++column_count;
+  }
+  insert << ") VALUES (" << values.str() << ")";
+  if (column_id != nullptr) {
+    insert << " RETURNING " << column_id->DatabaseName();
+  }
+  return insert.str();
+}
+
+bool PostgresDb::DumpTable(const std::string &dump_dir, const ITable &table) {
+  if (table.DatabaseName().empty()) {
+    return true;
+  }
+
+  DatabaseGuard db_open(*this);
+  if (!db_open.IsOk()) {
+    LOG_ERROR() << "Failed to open the database. Database: " << Name();
+    return false;
+  }
+
+  const SqlFilter fetch_all;
+  const size_t nof_items = Count(table, fetch_all);
+  if (nof_items == 0) {
+    // no meaning to create a dump file if it's empty.
+    return true;
+  }
+
+  const std::string filename = MakeDumpFilename(dump_dir, table);
+  if (filename.empty()) {
+    return false;
+  }
+  std::ofstream out_file(filename,std::ios_base::out | std::ios_base::trunc );
+  if (!out_file.is_open()) {
+    LOG_ERROR() << "Failed to open the file. File: " << filename;
+    return false;
+  }
+
+  // The rows are streamed from the server and written without any items.
+  std::vector<const IColumn*> column_list;
+  for (const auto& column : table.Columns()) {
+    if (!column.DatabaseName().empty()) {
+      column_list.push_back(&column);
+    }
+  }
+
+  size_t nof_rows = 0;
+  size_t failed_rows = 0;
+  try {
+    PostgresCopy copy_out(connection_);
+    copy_out.Start(MakeCopyOutSql(table, column_list, fetch_all));
+    std::string line;
+    std::vector<std::string_view> value_list;
+    while (copy_out.GetLine(line)) {
+      PostgresCopy::SplitLine(line, value_list);
+      if (value_list.size() != column_list.size()) {
+        ++failed_rows;
+        continue;
+      }
+      for (size_t index = 0; index < value_list.size(); ++index) {
+        AppendDumpValue(*column_list[index], value_list[index], out_file);
+        out_file << "^";
+      }
+      out_file << "\n";
+      ++nof_rows;
+    }
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to dump a table. Table: " << table.DatabaseName()
+      << ", Error: " << err.what();
+    return false;
+  }
+  if (failed_rows > 0) {
+    LOG_ERROR() << "Dump mismatch. Table/Failed Rows: " << table.DatabaseName()
+      << "/" << failed_rows;
+  }
+  return failed_rows == 0 && nof_rows > 0;
+}
+
+void PostgresDb::ExportCsv(const std::string &filename, const ITable &table,
+                           const SqlFilter &filter) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open.");
+  }
+  util::plot::CsvWriter csv_file(filename);
+  const auto& column_list = table.Columns();
+  std::vector<const IColumn*> copy_list;
+  for (const auto& column : column_list) {
+    csv_file.AddColumnHeader(column.ApplicationName(),column.Unit(), true);
+    if (!column.DatabaseName().empty()) {
+      copy_list.push_back(&column);
+    }
+  }
+  if (table.DatabaseName().empty() || copy_list.empty()) {
+    csv_file.CloseFile();
+    return;
+  }
+
+  PostgresCopy copy_out(connection_);
+  copy_out.Start(MakeCopyOutSql(table, copy_list, filter));
+  std::string line;
+  std::vector<std::string_view> value_list;
+  while (copy_out.GetLine(line)) {
+    PostgresCopy::SplitLine(line, value_list);
+    size_t value_index = 0;
+    for (const auto& column : column_list) {
+      if (column.DatabaseName().empty() || value_index >= value_list.size()) {
+        csv_file.AddColumnValue(std::string());
+        continue;
+      }
+      const auto copy_value = value_list[value_index++];
+      const bool null_value = copy_value == "\\N";
+      switch (column.DataType()) {
+        case DataType::DtString:
+        case DataType::DtExternalRef:
+          csv_file.AddColumnValue(null_value ?
+              std::string() : PostgresCopy::FromText(copy_value));
+          break;
+
+        case DataType::DtShort:
+        case DataType::DtByte:
+        case DataType::DtLong:
+        case DataType::DtLongLong:
+        case DataType::DtId:
+        case DataType::DtEnum:
+          csv_file.AddColumnValue(CopyNumber<int64_t>(copy_value));
+          break;
+
+        case DataType::DtFloat:
+          csv_file.AddColumnValue(CopyNumber<float>(copy_value));
+          break;
+
+        case DataType::DtDouble:
+          csv_file.AddColumnValue(CopyNumber<double>(copy_value));
+          break;
+
+        case DataType::DtBoolean:
+          csv_file.AddColumnValue(copy_value == "t");
+          break;
+
+        case DataType::DtDate:
+          csv_file.AddColumnValue(null_value ? uint64_t{0} :
+              IsoTimeToNs(std::string(copy_value), false));
+          break;
+
+        default:
+          csv_file.AddColumnValue(std::string());
+          break;
+      }
+    }
+    csv_file.AddRow();
+  }
+  csv_file.CloseFile();
+}
+
+size_t PostgresDb::BulkLoad(const ITable &table, std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+
+  const auto &column_list = table.Columns();
+  if (table.DatabaseName().empty() || column_list.empty() || row_list.empty()) {
+    return 0;
+  }
+
+  // Same columns as the Insert() function, so the server sets the index.
+  std::ostringstream copy;
+  copy << "COPY " << table.DatabaseName() << " (";
+  bool first = true;
+  for (const auto &col: column_list) {
+    if (IEquals(col.BaseName(), "id") || col.DatabaseName().empty()) {
+      continue;
+    }
+    if (!first) {
+      copy << ",";
+    }
+    first = false;
+    copy << col.DatabaseName();
+  }
+  copy << ") FROM STDIN";
+
+  // A failing COPY aborts the transaction, so it runs within a save point.
+  ExecuteSql("SAVEPOINT bulk_load");
+  size_t nof_rows = 0;
+  try {
+    PostgresCopy copy_in(connection_);
+    copy_in.Start(copy.str());
+    const TableLayout layout(table);
+    PostgresParameters parameters;
+    for (const IItem& row : row_list) {
+      parameters.Clear();
+      BindInsertValues(layout, row, parameters);
+      copy_in.AddRow(parameters);
+    }
+    nof_rows = copy_in.End();
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT bulk_load");
+    ExecuteSql("RELEASE SAVEPOINT bulk_load");
+    throw;
+  }
+  ExecuteSql("RELEASE SAVEPOINT bulk_load");
+  return nof_rows;
+}
+
+void PostgresDb::BindInsertValues(const TableLayout &layout, const IItem &row,
+                                  PostgresParameters &parameters) const {
+  // The attributes are mapped once instead of a name search per column.
+  const auto attr_list = layout.MapItem(row);
+  for (size_t ordinal = 0; ordinal < layout.NofColumns(); ++ordinal) {
+    const auto& col = layout.Column(ordinal);
+    if (IEquals(col.BaseName(), "id") || col.DatabaseName().empty()) {
+      continue;
+    }
+    const auto type = ColumnType(col);
+    const auto *attr = attr_list[ordinal];
+    if (attr != nullptr) {
+      // The user has set the item
+      switch (col.DataType()) {
+        case DataType::DtDate:
+          AddDateParameter(MakeDateValue(*attr), parameters);
+          break;
+
+        case DataType::DtString:
+        case DataType::DtExternalRef: {
+          const auto val = attr->Value<std::string>();
+          if (val.empty() && !col.Obligatory() && col.DefaultValue().empty()) {
+            parameters.AddNull(type);
+          } else {
+            parameters.AddText(val, type);
           }
+          break;
         }
+
+        case DataType::DtByteString:
+        case DataType::DtBlob:
+          if (attr->Value<std::string>().empty()) {
+            parameters.AddNull(type);
+          } else {
+            AddColumnParameter(col, *attr, parameters);
+          }
+          break;
+
+        case DataType::DtFloat:
+        case DataType::DtDouble:
+        case DataType::DtBoolean:
+          AddColumnParameter(col, *attr, parameters);
+          break;
+
+        default:
+          if (col.ReferenceId() > 0 && attr->Value<int64_t>() <= 0) {
+            parameters.AddNull(type);
+          } else if (attr->Value<std::string>().empty()) {
+            parameters.AddNull(type);
+          } else {
+            AddColumnParameter(col, *attr, parameters);
+          }
+          break;
       }
-      break;
+    } else if (IEquals(col.BaseName(), "ao_created") ||
+               IEquals(col.BaseName(), "version_date") ||
+               IEquals(col.BaseName(), "ao_last_modified")) {
+      // If these columns aren't set, then set them to 'now'.
+      const auto now = TimeStampToNs();
+      parameters.AddText(NsToIsoTime(now, 0), type);
+    } else if (!col.DefaultValue().empty()) {
+      // The server converts the text to the column type.
+      parameters.AddText(col.DefaultValue(), type);
+    } else if (col.Obligatory()) {
+      parameters.AddText(col.IsString() ? "" : "0", type);
+    } else {
+      parameters.AddNull(type);
+    }
+  }
+}
 
-    default:
-      break;
+void PostgresDb::Update(const ITable &table, IItem &row,
+                        const SqlFilter &filter) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
 
+  PostgresParameters parameters;
+  std::string update = MakeUpdateSql(table, row, parameters);
+  if (update.empty()) {
+    return;
   }
-  PQclear(result);
-  return ret_val;
+  update += " " + MakeWhereSql(filter, parameters);
+
+  // The filter values are bound, so the same update is prepared once.
+  ExecuteParameters(update, parameters, true);
+}
+
+void PostgresDb::UpdateBatch(const ITable &table, std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
+  }
+  const auto* column_id = table.GetColumnByBaseName("id");
+  if (column_id == nullptr || row_list.empty()) {
+    return;
+  }
+
+  std::vector<PipelineStatement> statement_list;
+  statement_list.reserve(row_list.size());
+  for (const IItem& row : row_list) {
+    PipelineStatement statement;
+    statement.sql = MakeUpdateSql(table, row, statement.parameters);
+    if (statement.sql.empty()) {
+      continue;
+    }
+    statement.sql += " WHERE " + column_id->DatabaseName() + "=$"
+        + std::to_string(statement.parameters.Size() + 1);
+    statement.parameters.AddInteger(row.ItemId(), PostgresType::BigInt);
+    statement_list.push_back(std::move(statement));
+  }
+  if (statement_list.empty()) {
+    return;
+  }
+
+  // Rows that update the same columns use the same prepared statement.
+  ExecuteSql("SAVEPOINT update_batch");
+  try {
+    ExecutePipeline(statement_list, true);
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT update_batch");
+    ExecuteSql("RELEASE SAVEPOINT update_batch");
+    throw;
+  }
+  ExecuteSql("RELEASE SAVEPOINT update_batch");
+}
+
+std::string PostgresDb::MakeUpdateSql(const ITable &table, const IItem &row,
+                                      PostgresParameters &parameters) const {
+  const auto &column_list = table.Columns();
+  if (table.DatabaseName().empty() || column_list.empty()) {
+    return {};
+  }
+
+  const auto now = TimeStampToNs();
+  std::ostringstream update;
+  update << "UPDATE " << table.DatabaseName() << " SET ";
+  for (const auto &col: column_list) {
+    if (col.DatabaseName().empty() || IEquals(col.BaseName(), "id")) {
+      continue;
+    }
+
+    const bool update_last_changed = IEquals(col.BaseName(), "ao_last_modified") ||
+                                     IEquals(col.BaseName(), "version_date");
+    const auto *attr = row.GetAttribute(col.ApplicationName());
+    if (attr == nullptr && !update_last_changed) {
+      // Do not change current value
+      continue;
+    }
+    if (parameters.Size() > 0) {
+      update << ",";
+    }
+    update << col.DatabaseName() << "=$" << parameters.Size() + 1;
+
+    const auto type = ColumnType(col);
+    if (attr == nullptr) {
+      parameters.AddText(NsToIsoTime(now, 0), type);
+    } else if (attr->IsValueEmpty() && !col.Obligatory()) {
+      parameters.AddNull(type);
+    } else if (col.DataType() == DataType::DtDate) {
+      AddDateParameter(MakeDateValue(*attr), parameters);
+    } else {
+      AddColumnParameter(col, *attr, parameters);
+    }
+  }
+  return parameters.Size() > 0 ? update.str() : std::string();
 }
 
 std::string PostgresDb::DataTypeToDbString(DataType type) {
@@ -226,11 +1162,12 @@ void PostgresDb::FetchNameMap(const ITable &table, IdNameMap& dest_list,
   std::ostringstream sql;
   sql << "SELECT " << column_id->DatabaseName() << "," << column_name->DatabaseName()
       << " FROM " << table.DatabaseName() ;
+  PostgresParameters parameters;
   if (!filter.IsEmpty()) {
-      sql << " " << filter.GetWhereStatement();
+      sql << " " << MakeWhereSql(filter, parameters);
   }
 
-  PostgresStatement select(connection_, sql.str());
+  PostgresStatement select(connection_, sql.str(), parameters);
   for (bool more = select.Step(); more ; more = select.Step()) {
       const auto index = select.Value<int64_t>(0);
       const auto name = select.Value<std::string>(1);
@@ -251,26 +1188,98 @@ void PostgresDb::FetchItemList(const ITable &table, ItemList& dest_list,
 
   std::ostringstream sql;
   sql << "SELECT * FROM " << table.DatabaseName() ;
+  PostgresParameters parameters;
   if (!filter.IsEmpty()) {
-      sql << " " << filter.GetWhereStatement();
+      sql << " " << MakeWhereSql(filter, parameters);
   }
 
-  PostgresStatement select(connection_, sql.str());
+  PostgresStatement select(connection_, sql.str(), parameters,
+                           binary_results_, static_cast<int>(fetch_size_));
+  std::vector<ResultBinding> binding_list;
+  bool bound = false;
   for (bool more = select.Step(); more ; more = select.Step()) {
-      const auto& column_list = table.Columns();
+      // The result columns are resolved once.
+      if (!bound) {
+        binding_list = MakeResultBindings(table, select);
+        bound = true;
+      }
       auto item = std::make_unique<IItem>();
       item->ApplicationId(table.ApplicationId());
+      AddResultAttributes(binding_list, select, *item);
+      dest_list.push_back(std::move(item));
+  }
+}
 
-      for (const auto& column : column_list) {
-        const auto index = select.GetColumnIndex(column.DatabaseName());
-        if (index < 0) {
-          continue;
+PostgresEventLoop& PostgresDb::EventLoop() {
+  if (!event_loop_) {
+    event_loop_ = std::make_unique<PostgresEventLoop>(ConnectionInfo(),
+                                                      max_async_queries_);
+  }
+  return *event_loop_;
+}
+
+std::future<ItemList> PostgresDb::FetchItemListAsync(const ITable &table,
+                                                     const SqlFilter &filter) {
+  auto promise = std::make_shared<std::promise<ItemList>>();
+  auto future = promise->get_future();
+  FetchItemListAsync(table, filter,
+                     [promise] (ItemList& item_list, const std::string& error) {
+    if (error.empty()) {
+      promise->set_value(std::move(item_list));
+    } else {
+      promise->set_exception(std::make_exception_ptr(std::runtime_error(error)));
+    }
+  });
+  return future;
+}
+
+void PostgresDb::FetchItemListAsync(const ITable &table,
+                                    const SqlFilter &filter,
+                                    FetchCallback OnDone) {
+  if (ConnectionInfo().empty()) {
+    throw std::runtime_error("The connection info is not set.");
+  }
+  if (table.DatabaseName().empty()) {
+    ItemList empty_list;
+    if (OnDone) {
+      OnDone(empty_list, {});
+    }
+    return;
+  }
+
+  std::ostringstream sql;
+  sql << "SELECT * FROM " << table.DatabaseName() ;
+  PostgresParameters parameters;
+  if (!filter.IsEmpty()) {
+    sql << " " << MakeWhereSql(filter, parameters);
+  }
+
+  // The result is converted by the event loop thread, so the table is copied.
+  EventLoop().Send(sql.str(), parameters, binary_results_,
+                   [table, OnDone = std::move(OnDone)]
+                   (PGresult* result, const std::string& error) {
+    ItemList item_list;
+    if (result != nullptr) {
+      PostgresStatement select(result);
+      std::vector<ResultBinding> binding_list;
+      bool bound = false;
+      for (bool more = select.Step(); more ; more = select.Step()) {
+        if (!bound) {
+          binding_list = MakeResultBindings(table, select);
+          bound = true;
         }
-        item->AppendAttribute({column.ApplicationName(), column.BaseName(), select.Value<std::string>(index)});
+        auto item = std::make_unique<IItem>();
+        item->ApplicationId(table.ApplicationId());
+        AddResultAttributes(binding_list, select, *item);
+        item_list.push_back(std::move(item));
       }
-      dest_list.push_back(std::move(item));
-  }
+    }
+    if (OnDone) {
+      OnDone(item_list, error);
+    }
+  });
 }
+
 size_t PostgresDb::FetchItems(const ITable &table, const SqlFilter &filter,
                               std::function<void(IItem &)> OnItem) {
   if (!IsOpen()) {
@@ -282,24 +1291,26 @@ size_t PostgresDb::FetchItems(const ITable &table, const SqlFilter &filter,
 
   std::ostringstream sql;
   sql << "SELECT * FROM " << table.DatabaseName() ;
+  PostgresParameters parameters;
   if (!filter.IsEmpty()) {
-      sql << " " << filter.GetWhereStatement();
+      sql << " " << MakeWhereSql(filter, parameters);
   }
   size_t count = 0;
-  PostgresStatement select(connection_, sql.str());
+  PostgresStatement select(connection_, sql.str(), parameters,
+                           binary_results_, static_cast<int>(fetch_size_));
+  std::vector<ResultBinding> binding_list;
+  bool bound = false;
   for (bool more = select.Step(); more ; more = select.Step()) {
-      const auto& column_list = table.Columns();
+      // The result columns are resolved once.
+      if (!bound) {
+        binding_list = MakeResultBindings(table, select);
+        bound = true;
+      }
       IItem item;
       item.ApplicationId(table.ApplicationId());
-
-      for (const auto& column : column_list) {
-        const auto index = select.GetColumnIndex(column.DatabaseName());
-        if (index < 0) {
-          continue;
-        }
-        item.AppendAttribute({column.ApplicationName(), column.BaseName(), select.Value<std::string>(index)});
-      }
+      AddResultAttributes(binding_list, select, item);
       OnItem(item);
+      ++count;
   }
   return count;
 }
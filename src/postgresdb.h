@@ -5,10 +5,16 @@
 
 #pragma once
 #include "ods/idatabase.h"
+#include "ods/tablelayout.h"
 #include <libpq-fe.h>
 #include <util/ilisten.h>
 #include <string>
 #include <memory>
+#include <future>
+#include <mutex>
+#include "postgresstatementcache.h"
+#include "postgresparameters.h"
+#include "postgreseventloop.h"
 
 namespace ods::detail {
 
@@ -23,6 +29,48 @@ public:
   bool Open() override;
   bool Close(bool commit) override;
   [[nodiscard]] bool IsOpen() const override;
+  [[nodiscard]] bool InTransaction() const override;
+
+  /** \brief Returns true if the connection is open and not broken. */
+  [[nodiscard]] bool IsConnectionOk() const;
+  /** \brief Closes a broken connection and opens a new connection.
+   *
+   * The prepared statements are lost when the connection closes. Same as
+   * the Open() function, a transaction is started.
+   * @return True if the new connection is open.
+   */
+  bool Reconnect();
+
+  /** \brief Sets the statement_timeout of the session.
+   *
+   * The timeout is applied when the connection opens. If the connection is
+   * open, the setting is changed directly, but a rollback of the current
+   * transaction restores the old setting.
+   */
+  void QueryTimeout(std::chrono::milliseconds timeout) override;
+  using IDatabase::QueryTimeout;
+  /** \brief Sends a cancel request for the running query with PQcancel(). */
+  void Interrupt() override;
+
+  void Insert(const ITable& table, IItem& row, const SqlFilter& filter) override;
+  /** \brief Inserts the rows in pipeline mode.
+   *
+   * All inserts are sent without waiting for each result, so the batch
+   * isn't limited by the network round-trip time. The new indexes are
+   * read from the results.
+   */
+  std::vector<int64_t> InsertBatch(const ITable& table,
+                                   std::span<IItem> row_list) override;
+  void Update(const ITable& table, IItem& row, const SqlFilter& filter) override;
+  /** \brief Updates the rows in pipeline mode. */
+  void UpdateBatch(const ITable& table, std::span<IItem> row_list) override;
+  /** \brief Bulk loads rows with the COPY FROM STDIN command.
+   *
+   * The rows are streamed to the server in the text COPY format, which is
+   * much faster than one INSERT per row. The index column is set by the
+   * server and the item id of the rows are not updated.
+   */
+  size_t BulkLoad(const ITable& table, std::span<IItem> row_list) override;
 
   int64_t ExecuteSql(const std::string& sql) override;
 
@@ -32,9 +80,75 @@ public:
                      const SqlFilter& filter) override;
 
   PGconn* Connection() {return connection_;}
+
+  /** \brief Called when an asynchronous fetch is done.
+   *
+   * The error text is empty if the fetch succeeded.
+   */
+  using FetchCallback = std::function<void(ItemList& item_list,
+                                           const std::string& error)>;
+
+  /** \brief Fetches the items without blocking the caller.
+   *
+   * The query runs on a background connection, so the database doesn't need
+   * to be open, but the connection info must be set. Note that the query
+   * doesn't see any uncommitted changes made by this connection.
+   * @param table Table definition. The table is copied.
+   * @param filter Where statement.
+   * @return A future with the item list. The future throws if the
+   * fetch failed.
+   */
+  [[nodiscard]] std::future<ItemList> FetchItemListAsync(const ITable& table,
+                                                  const SqlFilter& filter);
+  /** \brief Fetches the items and calls the callback when done.
+   *
+   * Same as above but the OnDone() function is called by a background
+   * thread. A GUI application should pass the result to its own thread.
+   */
+  void FetchItemListAsync(const ITable& table, const SqlFilter& filter,
+                          FetchCallback OnDone);
+
+  /** \brief Max number of asynchronous queries in flight. Default is 4.
+   *
+   * Each asynchronous query in flight uses its own connection. The value
+   * should be set before the first asynchronous query.
+   */
+  void MaxAsyncQueries(size_t max_queries) {
+    max_async_queries_ = max_queries;
+  }
+  [[nodiscard]] size_t MaxAsyncQueries() const { return max_async_queries_; }
+
+  /** \brief Fetches the items with results in the binary format.
+   *
+   * The FetchItems() and FetchItemList() functions request the results in
+   * the binary format. The numbers are then decoded without any text
+   * parsing, which is faster on large fetches. Note that BLOB attributes
+   * are Base64 strings in the binary format.
+   * @param binary Set to true to use the binary format.
+   */
+  void BinaryResults(bool binary) { binary_results_ = binary; }
+  [[nodiscard]] bool BinaryResults() const { return binary_results_; }
+
+  /** \brief Number of rows per block when fetching items.
+   *
+   * The FetchItems() and FetchItemList() functions fetch the rows through
+   * a server-side cursor in blocks of this size. Set to 0 to receive one
+   * row at the time in single-row mode.
+   * @param nof_rows Number of rows per block.
+   */
+  void FetchSize(size_t nof_rows) { fetch_size_ = nof_rows; }
+  [[nodiscard]] size_t FetchSize() const { return fetch_size_; }
   size_t FetchItems(const ITable &table, const SqlFilter &filter,
                     std::function<void(IItem &)> OnItem) override;
 
+  /** \brief Exports a table with the COPY TO STDOUT command.
+   *
+   * The rows are streamed from the server and written to the CSV file
+   * without creating any items, so the memory usage is constant.
+   */
+  void ExportCsv(const std::string& filename, const ITable& table,
+                 const SqlFilter& filter) override;
+
 protected:
   [[nodiscard]] std::string DataTypeToDbString(DataType type) override;
   [[nodiscard]] bool IsDataTypeString(DataType type) override;
@@ -45,13 +159,53 @@ protected:
   bool ReadSvcRefTable(IModel& model) override;
 
   bool FetchModelEnvironment(IModel& model) override;
+
+  /** \brief Dumps a table with the COPY TO STDOUT command.
+   *
+   * Same DBT format as the default function but the rows are streamed from
+   * the server and written without creating any items.
+   */
+  [[nodiscard]] bool DumpTable(const std::string& dump_dir,
+                               const ITable& table) override;
 private:
   PGconn* connection_ = nullptr;
   std::unique_ptr<util::log::IListen> listen_;
+  PostgresStatementCache statement_cache_; ///< Prepared statements
+  bool binary_results_ = false; ///< Fetch in binary format.
+  size_t fetch_size_ = 1'000; ///< Rows per fetch block.
+  size_t max_async_queries_ = 4;
+  std::unique_ptr<PostgresEventLoop> event_loop_; ///< Asynchronous queries.
+  std::mutex cancel_lock_;
+  PGcancel* cancel_ = nullptr; ///< Cancel object of the current connection.
 
+  [[nodiscard]] PostgresEventLoop& EventLoop();
+  void CloseConnection(); ///< Closes the connection without any commit.
+  void ApplyQueryTimeout();
   bool HandleConnectionStringError();
   bool HandleConnectionError();
 
+  void BindInsertValues(const TableLayout& layout, const IItem& row,
+                        PostgresParameters& parameters) const;
+  int64_t ExecuteParameters(const std::string& sql,
+                            const PostgresParameters& parameters,
+                            bool prepare);
+
+  struct PipelineStatement {
+    std::string sql;
+    PostgresParameters parameters;
+  };
+  /** \brief Sends the statements in pipeline mode.
+   *
+   * The prepare flag should only be set if the statements use a few
+   * different SQL texts.
+   * @return The first value of each result or 0 if no value.
+   */
+  std::vector<int64_t> ExecutePipeline(
+      const std::vector<PipelineStatement>& statement_list, bool prepare);
+  [[nodiscard]] static std::string MakeInsertSql(const ITable& table);
+  [[nodiscard]] std::string MakeUpdateSql(const ITable& table,
+                                          const IItem& row,
+                                          PostgresParameters& parameters) const;
 
 };
 
@@ -0,0 +1,343 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "postgreseventloop.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <util/logstream.h>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#else
+#include <sys/select.h>
+#endif
+
+using namespace util::log;
+using namespace std::chrono_literals;
+
+namespace {
+
+constexpr long kSelectTimeout = 50'000; ///< Max wait for input in us.
+/// Max time to make a new connection. PQconnectPoll() ignores the
+/// connect_timeout setting.
+constexpr auto kConnectTimeout = std::chrono::seconds(30);
+
+std::string ConnectionError(const PGconn* connection) {
+  const auto* msg = PQerrorMessage(connection);
+  return msg != nullptr ? msg : "";
+}
+
+} // end namespace
+
+namespace ods::detail {
+
+PostgresEventLoop::PostgresEventLoop(const std::string &connection_info,
+                                     size_t max_connections)
+: connection_info_(connection_info),
+  max_connections_(max_connections < 1 ? 1 : max_connections) {
+  worker_thread_ = std::thread(&PostgresEventLoop::WorkerThread, this);
+}
+
+PostgresEventLoop::~PostgresEventLoop() {
+  Stop();
+}
+
+void PostgresEventLoop::Send(const std::string &sql, bool binary,
+                             ResultCallback OnResult) {
+  Send(sql, PostgresParameters(), binary, std::move(OnResult));
+}
+
+void PostgresEventLoop::Send(const std::string &sql,
+                             const PostgresParameters &parameters,
+                             bool binary, ResultCallback OnResult) {
+  {
+    // The stop flag is checked inside the lock, so a queued query is
+    // either run or cancelled by the worker thread.
+    std::lock_guard lock(queue_lock_);
+    if (!stop_thread_) {
+      queue_.push_back({sql, parameters, binary, std::move(OnResult)});
+      queue_condition_.notify_one();
+      return;
+    }
+  }
+  if (OnResult) {
+    OnResult(nullptr, "The query loop is stopped.");
+  }
+}
+
+void PostgresEventLoop::Stop() {
+  stop_thread_ = true;
+  queue_condition_.notify_one();
+  if (worker_thread_.joinable()) {
+    worker_thread_.join();
+  }
+}
+
+size_t PostgresEventLoop::NofPending() const {
+  std::lock_guard lock(queue_lock_);
+  return queue_.size() + nof_active_;
+}
+
+void PostgresEventLoop::WorkerThread() {
+  while (!stop_thread_) {
+    StartQueries();
+    if (active_list_.empty()) {
+      std::unique_lock lock(queue_lock_);
+      queue_condition_.wait_for(lock, 1s, [&] {
+        return stop_thread_.load() || !queue_.empty();
+      });
+      continue;
+    }
+
+    WaitForInput();
+    for (auto itr = active_list_.begin(); itr != active_list_.end(); ) {
+      const bool done = itr->connecting ? PollConnection(*itr)
+                                        : ReadResults(*itr);
+      if (done) {
+        Complete(*itr);
+        itr = active_list_.erase(itr);
+      } else {
+        ++itr;
+      }
+    }
+    nof_active_ = active_list_.size();
+  }
+  CancelAll();
+}
+
+void PostgresEventLoop::StartQueries() {
+  while (active_list_.size() < max_connections_ && !stop_thread_) {
+    ActiveQuery active;
+    {
+      std::lock_guard lock(queue_lock_);
+      if (queue_.empty()) {
+        break;
+      }
+      active.query = std::move(queue_.front());
+      queue_.pop_front();
+    }
+
+    if (!idle_list_.empty()) {
+      active.connection = idle_list_.back();
+      idle_list_.pop_back();
+    } else if (!StartConnection(active)) {
+      Complete(active);
+      continue;
+    }
+
+    // A new connection sends the query when it is connected.
+    if (!active.connecting && !SendQuery(active)) {
+      Complete(active);
+      continue;
+    }
+    active_list_.push_back(std::move(active));
+    nof_active_ = active_list_.size();
+  }
+}
+
+void PostgresEventLoop::WaitForInput() {
+  fd_set input_set;
+  fd_set output_set;
+  FD_ZERO(&input_set);
+  FD_ZERO(&output_set);
+  int max_socket = -1;
+  for (auto& active : active_list_) {
+    active.ready = false;
+    const auto socket = PQsocket(active.connection);
+    if (socket < 0) {
+      continue;
+    }
+    if (active.connecting && active.poll_status == PGRES_POLLING_WRITING) {
+      FD_SET(socket, &output_set);
+    } else {
+      FD_SET(socket, &input_set);
+    }
+    max_socket = std::max(max_socket, socket);
+  }
+  if (max_socket < 0) {
+    return;
+  }
+  // The timeout is needed to start queued queries.
+  timeval timeout {0, kSelectTimeout};
+  if (select(max_socket + 1, &input_set, &output_set, nullptr, &timeout) <= 0) {
+    return;
+  }
+  for (auto& active : active_list_) {
+    const auto socket = PQsocket(active.connection);
+    active.ready = socket >= 0 && (FD_ISSET(socket, &input_set) ||
+                                   FD_ISSET(socket, &output_set));
+  }
+}
+
+bool PostgresEventLoop::StartConnection(ActiveQuery &active) const {
+  auto* connection = PQconnectStart(connection_info_.c_str());
+  if (connection == nullptr || PQstatus(connection) == CONNECTION_BAD) {
+    active.error = "Failed to connect to the database.";
+    LOG_ERROR() << "Failed to connect. Error: "
+                << (connection != nullptr ? ConnectionError(connection) : "");
+    PQfinish(connection);
+    return false;
+  }
+  active.connection = connection;
+  active.connecting = true;
+  active.poll_status = PGRES_POLLING_WRITING;
+  active.connect_start = std::chrono::steady_clock::now();
+  return true;
+}
+
+bool PostgresEventLoop::PollConnection(ActiveQuery &active) const {
+  // PQconnectPoll() shall only be called when the socket is ready.
+  if (!active.ready) {
+    if (std::chrono::steady_clock::now() - active.connect_start
+        < kConnectTimeout) {
+      return false;
+    }
+    active.error = "Timeout connecting to the database.";
+    LOG_ERROR() << "Failed to connect. Error: " << active.error;
+    return true;
+  }
+
+  active.poll_status = PQconnectPoll(active.connection);
+  switch (active.poll_status) {
+    case PGRES_POLLING_OK:
+      active.connecting = false;
+      return !SendQuery(active);
+
+    case PGRES_POLLING_FAILED:
+      active.error = "Failed to connect to the database.";
+      LOG_ERROR() << "Failed to connect. Error: "
+                  << ConnectionError(active.connection);
+      return true;
+
+    default:
+      break;
+  }
+  return false;
+}
+
+bool PostgresEventLoop::SendQuery(ActiveQuery &active) const {
+  const auto& sql = active.query.sql;
+  const auto& parameters = active.query.parameters;
+  const bool binary = active.query.binary;
+  // The parameters and the result format can only be sent with the
+  // extended query protocol.
+  const auto send = binary || parameters.Size() > 0 ?
+      PQsendQueryParams(active.connection, sql.c_str(), parameters.Size(),
+                        parameters.Types(), parameters.Values(),
+                        parameters.Lengths(), parameters.Formats(),
+                        binary ? 1 : 0) :
+      PQsendQuery(active.connection, sql.c_str());
+  if (send != 1) {
+    active.error = ConnectionError(active.connection);
+    LOG_ERROR() << "Query error: Error: " << active.error << ", SQL: " << sql;
+    return false;
+  }
+  return true;
+}
+
+bool PostgresEventLoop::ReadResults(ActiveQuery &active) const {
+  auto* connection = active.connection;
+  if (PQconsumeInput(connection) == 0) {
+    if (active.error.empty()) {
+      active.error = ConnectionError(connection);
+    }
+    return true;
+  }
+
+  while (PQisBusy(connection) == 0) {
+    auto* result = PQgetResult(connection);
+    if (result == nullptr) {
+      return true; // All results are read.
+    }
+    const auto status = PQresultStatus(result);
+    if (status == PGRES_TUPLES_OK || status == PGRES_COMMAND_OK) {
+      if (active.result != nullptr) {
+        PQclear(active.result);
+      }
+      active.result = result;
+    } else {
+      if (active.error.empty()) {
+        const auto* msg = PQresultErrorMessage(result);
+        active.error = msg != nullptr ? msg : "";
+        LOG_ERROR() << "Query error: Error: " << active.error
+                    << ", SQL: " << active.query.sql;
+      }
+      PQclear(result);
+    }
+  }
+  return false;
+}
+
+void PostgresEventLoop::Complete(ActiveQuery &active) {
+  if (active.query.OnResult) {
+    try {
+      active.query.OnResult(active.error.empty() ? active.result : nullptr,
+                            active.error);
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Query callback error. Error: " << err.what()
+                  << ", SQL: " << active.query.sql;
+    }
+  }
+  if (active.result != nullptr) {
+    PQclear(active.result);
+    active.result = nullptr;
+  }
+
+  auto* connection = active.connection;
+  active.connection = nullptr;
+  if (connection == nullptr) {
+    return;
+  }
+  // A broken connection is closed and a new one is opened on the next query.
+  if (!stop_thread_ && PQstatus(connection) == CONNECTION_OK &&
+      PQtransactionStatus(connection) == PQTRANS_IDLE) {
+    idle_list_.push_back(connection);
+  } else {
+    PQfinish(connection);
+  }
+}
+
+void PostgresEventLoop::CancelAll() {
+  const std::string cancelled = "The query was cancelled.";
+  for (auto& active : active_list_) {
+    // A connection that isn't connected yet, has nothing to cancel.
+    auto* cancel = active.connecting ? nullptr
+                                     : PQgetCancel(active.connection);
+    if (cancel != nullptr) {
+      std::array<char, 256> error {};
+      PQcancel(cancel, error.data(), static_cast<int>(error.size()));
+      PQfreeCancel(cancel);
+    }
+    if (active.result != nullptr) {
+      PQclear(active.result);
+      active.result = nullptr;
+    }
+    active.error = cancelled;
+    Complete(active);
+  }
+  active_list_.clear();
+  nof_active_ = 0;
+
+  std::deque<AsyncQuery> queue;
+  {
+    std::lock_guard lock(queue_lock_);
+    queue = std::move(queue_);
+    queue_.clear();
+  }
+  for (auto& query : queue) {
+    ActiveQuery active;
+    active.query = std::move(query);
+    active.error = cancelled;
+    Complete(active);
+  }
+
+  for (auto* connection : idle_list_) {
+    PQfinish(connection);
+  }
+  idle_list_.clear();
+}
+
+} // namespace ods::detail
@@ -0,0 +1,124 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <libpq-fe.h>
+#include "postgresparameters.h"
+
+namespace ods::detail {
+
+/** \brief Runs Postgres queries in the background.
+ *
+ * The queries are sent with PQsendQuery() and a worker thread waits for the
+ * results on the connection sockets, so the caller never blocks. New
+ * connections are made with PQconnectPoll() in the same wait, so a slow
+ * connect doesn't stop the other queries. Each query
+ * in flight uses its own connection, which means that up to N independent
+ * queries may run at the same time. Later queries are queued until a
+ * connection is free. The connections are opened when needed and kept open
+ * until the loop stops.
+ *
+ * The queries run in auto-commit mode on their own connections, so they
+ * don't see any uncommitted changes made by other connections.
+ *
+ * The result callback is called by the worker thread. The result is
+ * deleted when the callback returns. Any queued or running queries are
+ * cancelled when the loop stops, and their callbacks are called with an
+ * error text.
+ */
+class PostgresEventLoop final {
+public:
+  /** \brief Called when a query is done.
+   *
+   * The result is the last result of the query and may be null if the
+   * query failed. The error text is empty if the query succeeded.
+   */
+  using ResultCallback = std::function<void(PGresult* result,
+                                            const std::string& error)>;
+
+  explicit PostgresEventLoop(const std::string& connection_info,
+                             size_t max_connections = 4);
+  ~PostgresEventLoop();
+
+  PostgresEventLoop() = delete;
+  PostgresEventLoop(const PostgresEventLoop&) = delete;
+  PostgresEventLoop& operator = (const PostgresEventLoop&) = delete;
+
+  [[nodiscard]] const std::string& ConnectionInfo() const {
+    return connection_info_;
+  }
+  [[nodiscard]] size_t MaxConnections() const { return max_connections_; }
+
+  /** \brief Queues a query.
+   *
+   * @param sql SQL query.
+   * @param binary Set to true to request the result in binary format.
+   * @param OnResult Called by the worker thread when the query is done.
+   */
+  void Send(const std::string& sql, bool binary, ResultCallback OnResult);
+  /** \brief Queues a query with $1, $2... parameters. */
+  void Send(const std::string& sql, const PostgresParameters& parameters,
+            bool binary, ResultCallback OnResult);
+
+  /** \brief Cancels all queries and stops the worker thread. */
+  void Stop();
+
+  /** \brief Number of queued and running queries. */
+  [[nodiscard]] size_t NofPending() const;
+
+private:
+  struct AsyncQuery {
+    std::string sql;
+    PostgresParameters parameters;
+    bool binary = false;
+    ResultCallback OnResult;
+  };
+
+  struct ActiveQuery {
+    PGconn* connection = nullptr;
+    AsyncQuery query;
+    PGresult* result = nullptr; ///< Last tuple or command result.
+    std::string error;
+    bool connecting = false; ///< True until a new connection is made.
+    PostgresPollingStatusType poll_status = PGRES_POLLING_WRITING;
+    std::chrono::steady_clock::time_point connect_start;
+    bool ready = false; ///< The socket was ready in the last wait.
+  };
+
+  std::string connection_info_;
+  size_t max_connections_ = 4;
+
+  std::atomic<bool> stop_thread_ = false;
+  std::thread worker_thread_;
+  mutable std::mutex queue_lock_;
+  std::condition_variable queue_condition_;
+  std::deque<AsyncQuery> queue_;
+  std::atomic<size_t> nof_active_ = 0;
+
+  // Only used by the worker thread.
+  std::vector<ActiveQuery> active_list_;
+  std::vector<PGconn*> idle_list_;
+
+  void WorkerThread();
+  void StartQueries();
+  void WaitForInput();
+  [[nodiscard]] bool StartConnection(ActiveQuery& active) const;
+  [[nodiscard]] bool PollConnection(ActiveQuery& active) const;
+  [[nodiscard]] bool SendQuery(ActiveQuery& active) const;
+  [[nodiscard]] bool ReadResults(ActiveQuery& active) const;
+  void Complete(ActiveQuery& active);
+  void CancelAll();
+};
+
+} // namespace ods::detail
@@ -0,0 +1,116 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "postgresparameters.h"
+#include <bit>
+#include <cstring>
+
+namespace {
+
+// The binary format is in network byte order (big-endian).
+template <typename T>
+std::string ToBinary(T value) {
+  std::string binary(sizeof(T), '\0');
+  for (size_t byte = 0; byte < sizeof(T); ++byte) {
+    binary[sizeof(T) - 1 - byte] = static_cast<char>(value & 0xFF);
+    value >>= 8;
+  }
+  return binary;
+}
+
+} // end namespace
+
+namespace ods::detail {
+
+void PostgresParameters::AddValue(std::string value, PostgresType type,
+                                  bool binary) {
+  length_list_.push_back(static_cast<int>(value.size()));
+  value_list_.push_back(std::move(value));
+  null_list_.push_back(false);
+  type_list_.push_back(static_cast<Oid>(type));
+  format_list_.push_back(binary ? 1 : 0);
+}
+
+void PostgresParameters::AddNull(PostgresType type) {
+  value_list_.emplace_back();
+  null_list_.push_back(true);
+  type_list_.push_back(static_cast<Oid>(type));
+  length_list_.push_back(0);
+  format_list_.push_back(0);
+}
+
+void PostgresParameters::AddText(const std::string &value, PostgresType type) {
+  AddValue(value, type, false);
+}
+
+void PostgresParameters::AddInteger(int64_t value, PostgresType type) {
+  switch (type) {
+    case PostgresType::SmallInt:
+      AddValue(ToBinary(static_cast<uint16_t>(value)), type, true);
+      break;
+
+    case PostgresType::Integer:
+      AddValue(ToBinary(static_cast<uint32_t>(value)), type, true);
+      break;
+
+    case PostgresType::BigInt:
+      AddValue(ToBinary(static_cast<uint64_t>(value)), type, true);
+      break;
+
+    default:
+      AddValue(std::to_string(value), type, false);
+      break;
+  }
+}
+
+void PostgresParameters::AddFloat(double value, PostgresType type) {
+  if (type == PostgresType::Real) {
+    const auto bits = std::bit_cast<uint32_t>(static_cast<float>(value));
+    AddValue(ToBinary(bits), type, true);
+  } else {
+    const auto bits = std::bit_cast<uint64_t>(value);
+    AddValue(ToBinary(bits), PostgresType::Double, true);
+  }
+}
+
+void PostgresParameters::AddBoolean(bool value) {
+  AddValue(std::string(1, value ? '\1' : '\0'), PostgresType::Boolean, true);
+}
+
+void PostgresParameters::AddBytes(const std::vector<uint8_t> &value) {
+  std::string binary(value.size(), '\0');
+  if (!value.empty()) {
+    std::memcpy(binary.data(), value.data(), value.size());
+  }
+  AddValue(std::move(binary), PostgresType::ByteArray, true);
+}
+
+bool PostgresParameters::IsNull(int index) const {
+  return index < 0 || index >= Size() || null_list_[index];
+}
+
+PostgresType PostgresParameters::Type(int index) const {
+  return static_cast<PostgresType>(type_list_.at(index));
+}
+
+const char *const *PostgresParameters::Values() const {
+  pointer_list_.resize(value_list_.size(), nullptr);
+  for (size_t index = 0; index < value_list_.size(); ++index) {
+    pointer_list_[index] = null_list_[index] ?
+        nullptr : value_list_[index].data();
+  }
+  return pointer_list_.data();
+}
+
+void PostgresParameters::Clear() {
+  value_list_.clear();
+  null_list_.clear();
+  type_list_.clear();
+  length_list_.clear();
+  format_list_.clear();
+  pointer_list_.clear();
+}
+
+} // namespace ods::detail
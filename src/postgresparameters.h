@@ -0,0 +1,80 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <libpq-fe.h>
+
+namespace ods::detail {
+
+/** \brief Type OID of the Postgres built-in types. */
+enum class PostgresType : Oid {
+  Unknown = 0,         ///< The server decides the type from the SQL.
+  Boolean = 16,        ///< bool
+  ByteArray = 17,      ///< bytea
+  BigInt = 20,         ///< int8
+  SmallInt = 21,       ///< int2
+  Integer = 23,        ///< int4
+  Text = 25,           ///< text
+  Real = 700,          ///< float4
+  Double = 701,        ///< float8
+  Varchar = 1043,      ///< varchar
+  Timestamp = 1114,    ///< timestamp without time zone
+  TimestampTz = 1184,  ///< timestamp with time zone
+};
+
+/** \brief Parameter values that are bound to a Postgres statement.
+ *
+ * The values are sent separate from the SQL text, so they don't need any
+ * quoting and the SQL text is the same for all rows. Each parameter has a
+ * type. A prepared statement gets its parameter types when it is prepared,
+ * so the type should depend on the column and not on the value.
+ *
+ * Numbers, booleans and byte arrays are sent in the binary format, which
+ * means that the server doesn't need to parse them. Text and timestamps are
+ * sent in the text format.
+ */
+class PostgresParameters final {
+public:
+  void AddNull(PostgresType type = PostgresType::Unknown);
+  void AddText(const std::string& value,
+               PostgresType type = PostgresType::Unknown);
+  /** \brief Adds an integer. The type should be SmallInt, Integer or BigInt.*/
+  void AddInteger(int64_t value, PostgresType type = PostgresType::BigInt);
+  /** \brief Adds a float. The type should be Real or Double. */
+  void AddFloat(double value, PostgresType type = PostgresType::Double);
+  void AddBoolean(bool value);
+  void AddBytes(const std::vector<uint8_t>& value);
+
+  [[nodiscard]] int Size() const {
+    return static_cast<int>(value_list_.size());
+  }
+  [[nodiscard]] bool IsNull(int index) const;
+  [[nodiscard]] PostgresType Type(int index) const;
+
+  /** \brief Returns the values as an array that libpq uses.
+   *
+   * The array is valid until the next change of the parameters.
+   */
+  [[nodiscard]] const char* const* Values() const;
+  [[nodiscard]] const Oid* Types() const { return type_list_.data(); }
+  [[nodiscard]] const int* Lengths() const { return length_list_.data(); }
+  [[nodiscard]] const int* Formats() const { return format_list_.data(); }
+
+  void Clear();
+private:
+  std::vector<std::string> value_list_; ///< Text or binary value.
+  std::vector<bool> null_list_;
+  std::vector<Oid> type_list_;
+  std::vector<int> length_list_;
+  std::vector<int> format_list_; ///< 0 = text, 1 = binary.
+  mutable std::vector<const char*> pointer_list_;
+
+  void AddValue(std::string value, PostgresType type, bool binary);
+};
+
+} // namespace ods::detail
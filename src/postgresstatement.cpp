@@ -4,6 +4,13 @@
 */
 
 #include "postgresstatement.h"
+#include <array>
+#include <atomic>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <limits>
+#include <string_view>
 #include <util/logstream.h>
 #include <util/timestamp.h>
 
@@ -40,14 +47,63 @@ namespace {
     }
     return 0;
   }
+
+  // Microseconds between 1970-01-01 and the Postgres epoch 2000-01-01.
+  constexpr int64_t kPostgresEpoch = 946'684'800'000'000;
+  // Largest time (us since 2000) that fits as nanoseconds since 1970.
+  constexpr int64_t kMaxPostgresTime = static_cast<int64_t>(
+      std::numeric_limits<uint64_t>::max() / 1'000) - kPostgresEpoch;
+
+  // The binary values are in network byte order (big-endian).
+  uint64_t FromBinary(const char* value, int length) {
+    uint64_t temp = 0;
+    for (int byte = 0; byte < length && byte < 8; ++byte) {
+      temp <<= 8;
+      temp |= static_cast<uint8_t>(value[byte]);
+    }
+    return temp;
+  }
+
+  // SQLSTATE of a query that is cancelled or timed out.
+  constexpr std::string_view kQueryCanceled = "57014";
+
+  bool IsQueryCanceled(const PGresult* result) {
+    const auto* state = PQresultErrorField(result, PG_DIAG_SQLSTATE);
+    return state != nullptr && kQueryCanceled == state;
+  }
 }
 
 namespace ods::detail {
 
 PostgresStatement::PostgresStatement(PGconn *connection,
-                                     const std::string &sql)
-: connection_(connection) {
-  const auto send = PQsendQuery(connection_, sql.c_str());
+                                     const std::string &sql, bool binary,
+                                     int fetch_size)
+: PostgresStatement(connection, sql, PostgresParameters(), binary,
+                    fetch_size) {
+}
+
+PostgresStatement::PostgresStatement(PGconn *connection,
+                                     const std::string &sql,
+                                     const PostgresParameters &parameters,
+                                     bool binary, int fetch_size)
+: connection_(connection),
+  binary_(binary),
+  fetch_size_(fetch_size) {
+  // A cursor can only be used within a transaction.
+  if (fetch_size_ > 0 && connection_ != nullptr &&
+      PQtransactionStatus(connection_) == PQTRANS_INTRANS) {
+    DeclareCursor(sql, parameters);
+    return;
+  }
+
+  // The parameters and the result format can only be sent with the
+  // extended query protocol.
+  const auto send = binary || parameters.Size() > 0 ?
+      PQsendQueryParams(connection_, sql.c_str(), parameters.Size(),
+                        parameters.Types(), parameters.Values(),
+                        parameters.Lengths(), parameters.Formats(),
+                        binary ? 1 : 0) :
+      PQsendQuery(connection_, sql.c_str());
   if (send != 1) {
     const auto* msg = PQerrorMessage(connection_);
     const std::string err = msg != nullptr ? msg : "";
@@ -62,16 +118,111 @@ PostgresStatement::PostgresStatement(PGconn *connection,
     }
   }
 }
+
+PostgresStatement::PostgresStatement(PGresult *result)
+: result_(result),
+  row_(-1) {
+}
+
 PostgresStatement::~PostgresStatement() {
+  if (connection_ == nullptr) {
+    return; // The result is owned by the caller.
+  }
+  if (!cursor_.empty()) {
+    if (result_ != nullptr) {
+      PQclear(result_);
+      result_ = nullptr;
+    }
+    // The cursor is closed by the end of the transaction as well.
+    if (PQtransactionStatus(connection_) == PQTRANS_INTRANS) {
+      const std::string close = "CLOSE " + cursor_;
+      PQclear(PQexec(connection_, close.c_str()));
+    }
+    return;
+  }
   while (result_ != nullptr) {
     PQclear(result_);
     result_ = PQgetResult(connection_);
   }
 }
 
+void PostgresStatement::DeclareCursor(const std::string &sql,
+                                      const PostgresParameters &parameters) {
+  static std::atomic<uint64_t> cursor_counter = 0;
+  cursor_ = "ods_cursor_" + std::to_string(++cursor_counter);
+
+  std::ostringstream declare;
+  declare << "DECLARE " << cursor_ << " NO SCROLL CURSOR FOR " << sql;
+  auto* result = PQexecParams(connection_, declare.str().c_str(),
+                              parameters.Size(), parameters.Types(),
+                              parameters.Values(), parameters.Lengths(),
+                              parameters.Formats(), 0);
+  if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+    const auto* msg = PQresultErrorMessage(result);
+    const std::string err = msg != nullptr ? msg : "";
+    LOG_ERROR() << "Query error: Error: " << err << ", SQL: " << sql;
+    end_of_cursor_ = true;
+  }
+  PQclear(result);
+
+  std::ostringstream fetch;
+  fetch << "FETCH " << fetch_size_ << " FROM " << cursor_;
+  fetch_sql_ = fetch.str();
+}
+
+bool PostgresStatement::StepCursor() {
+  if (result_ != nullptr && row_ + 1 < PQntuples(result_)) {
+    ++row_;
+    return true;
+  }
+  if (result_ != nullptr) {
+    PQclear(result_);
+    result_ = nullptr;
+  }
+  row_ = 0;
+  if (end_of_cursor_) {
+    return false;
+  }
+
+  // The rows are fetched in blocks, one result per block.
+  result_ = PQexecParams(connection_, fetch_sql_.c_str(), 0, nullptr, nullptr,
+                         nullptr, nullptr, binary_ ? 1 : 0);
+  if (PQresultStatus(result_) != PGRES_TUPLES_OK) {
+    const auto* msg = PQresultErrorMessage(result_);
+    const std::string err = msg != nullptr ? msg : "";
+    LOG_ERROR() << "Fetch error: Error: " << err << ", SQL: " << fetch_sql_;
+    end_of_cursor_ = true;
+    const bool canceled = IsQueryCanceled(result_);
+    PQclear(result_);
+    result_ = nullptr;
+    if (canceled) {
+      throw std::runtime_error("The query was cancelled. Error: " + err);
+    }
+    return false;
+  }
+  const auto nof_rows = PQntuples(result_);
+  if (nof_rows < fetch_size_) {
+    end_of_cursor_ = true;
+  }
+  if (nof_rows <= 0) {
+    PQclear(result_);
+    result_ = nullptr;
+    return false;
+  }
+  return true;
+}
+
 bool PostgresStatement::Step() {
   if (connection_ == nullptr) {
-    return false;
+    // Steps through a complete result.
+    if (result_ == nullptr) {
+      return false;
+    }
+    ++row_;
+    return row_ < PQntuples(result_);
+  }
+  if (!cursor_.empty()) {
+    return StepCursor();
   }
   if (result_ != nullptr) {
     PQclear(result_);
@@ -82,6 +233,12 @@ bool PostgresStatement::Step() {
     if (status == PGRES_SINGLE_TUPLE) {
       return true;
     }
+    // A cancelled query or a timeout should not look like an end of rows.
+    if (status == PGRES_FATAL_ERROR && IsQueryCanceled(result_)) {
+      const auto* msg = PQresultErrorMessage(result_);
+      const std::string err = msg != nullptr ? msg : "";
+      throw std::runtime_error("The query was cancelled. Error: " + err);
+    }
   }
   // PGRES_TUPLE_OK is received at the end
   return false;
@@ -95,16 +252,135 @@ int PostgresStatement::GetColumnIndex(const std::string &column_name) const {
 
 }
 
+bool PostgresStatement::IsNull(int column) const {
+  return result_ == nullptr || column < 0 || column >= PQnfields(result_)
+    || PQgetisnull(result_, row_, column) == 1;
+}
+
+bool PostgresStatement::IsBinary(int column) const {
+  return result_ != nullptr && column >= 0 && column < PQnfields(result_)
+    && PQfformat(result_, column) == 1;
+}
+
+PostgresType PostgresStatement::ColumnType(int column) const {
+  if (result_ == nullptr || column < 0 || column >= PQnfields(result_)) {
+    return PostgresType::Unknown;
+  }
+  return static_cast<PostgresType>(PQftype(result_, column));
+}
+
+int64_t PostgresStatement::BinaryInteger(int column) const {
+  const auto* value = PQgetvalue(result_, row_, column);
+  const auto length = PQgetlength(result_, row_, column);
+  if (value == nullptr) {
+    return 0;
+  }
+  const auto bits = FromBinary(value, length);
+  switch (length) {
+    case 1: return static_cast<int8_t>(bits);
+    case 2: return static_cast<int16_t>(bits);
+    case 4: return static_cast<int32_t>(bits);
+    default: break;
+  }
+  return static_cast<int64_t>(bits);
+}
+
+double PostgresStatement::BinaryFloat(int column) const {
+  const auto* value = PQgetvalue(result_, row_, column);
+  const auto length = PQgetlength(result_, row_, column);
+  if (value == nullptr) {
+    return 0.0;
+  }
+  const auto bits = FromBinary(value, length);
+  switch (length) {
+    case 4: return std::bit_cast<float>(static_cast<uint32_t>(bits));
+    case 8: return std::bit_cast<double>(bits);
+    default: break;
+  }
+  return 0.0;
+}
+
+uint64_t PostgresStatement::BinaryTime(int column) const {
+  // The value is microseconds since 2000-01-01.
+  // The value is clamped, as 'infinity' is INT64_MAX and times after the
+  // year 2554 don't fit as nanoseconds since 1970.
+  const int64_t micro_sec = BinaryInteger(column);
+  if (micro_sec <= -kPostgresEpoch) {
+    return 0;
+  }
+  if (micro_sec >= kMaxPostgresTime) {
+    return std::numeric_limits<uint64_t>::max();
+  }
+  return static_cast<uint64_t>(micro_sec + kPostgresEpoch) * 1'000;
+}
+
+std::string PostgresStatement::BinaryText(int column) const {
+  if (IsNull(column)) {
+    return {};
+  }
+  switch (ColumnType(column)) {
+    case PostgresType::SmallInt:
+    case PostgresType::Integer:
+    case PostgresType::BigInt:
+      return std::to_string(BinaryInteger(column));
+
+    case PostgresType::Boolean:
+      return BinaryInteger(column) != 0 ? "t" : "f";
+
+    case PostgresType::Real:
+    case PostgresType::Double: {
+      std::array<char, 32> text {};
+      const auto [end, ec] = std::to_chars(text.data(),
+                                           text.data() + text.size(),
+                                           BinaryFloat(column));
+      return ec == std::errc() ? std::string(text.data(), end) : std::string();
+    }
+
+    case PostgresType::Timestamp:
+    case PostgresType::TimestampTz:
+      return NsToIsoTime(BinaryTime(column), 3);
+
+    case PostgresType::ByteArray: {
+      // Same as the text format (\x0102).
+      constexpr std::string_view kHex = "0123456789abcdef";
+      const auto* value = PQgetvalue(result_, row_, column);
+      const auto length = PQgetlength(result_, row_, column);
+      std::string text = "\\x";
+      text.reserve(2 + (2 * length));
+      for (int byte = 0; byte < length; ++byte) {
+        const auto data = static_cast<uint8_t>(value[byte]);
+        text.push_back(kHex[data >> 4]);
+        text.push_back(kHex[data & 0x0F]);
+      }
+      return text;
+    }
+
+    default:
+      break;
+  }
+  // Text types are sent as is.
+  return {PQgetvalue(result_, row_, column),
+          static_cast<size_t>(PQgetlength(result_, row_, column))};
+}
+
 template <>
 void PostgresStatement::GetValue(int column, std::vector<uint8_t>& value) const {
   value.clear();
   if (result_ == nullptr) {
     throw std::runtime_error("No statement result is found. Invalid use.");
   }
-  if (PQgetisnull(result_,0, column)) {
+  if (PQgetisnull(result_, row_, column)) {
+    return;
+  }
+  if (IsBinary(column)) {
+    const auto* data = PQgetvalue(result_, row_, column);
+    const auto length = PQgetlength(result_, row_, column);
+    if (data != nullptr && length > 0) {
+      value.assign(data, data + length);
+    }
     return;
   }
-  const auto* text = PQgetvalue(result_, 0, column);
+  const auto* text = PQgetvalue(result_, row_, column);
   if (text == nullptr) {
     return;
   }
@@ -136,7 +412,25 @@ void PostgresStatement::GetValue(int column, uint64_t& value) const {
   if (result_ == nullptr) {
     throw std::runtime_error("No statement result is found. Invalid use.");
   }
-  const auto* text = PQgetvalue(result_, 0, column);
+  if (IsBinary(column)) {
+    switch (ColumnType(column)) {
+      case PostgresType::Timestamp:
+      case PostgresType::TimestampTz:
+        value = BinaryTime(column);
+        break;
+
+      case PostgresType::Real:
+      case PostgresType::Double:
+        value = static_cast<uint64_t>(BinaryFloat(column));
+        break;
+
+      default:
+        value = static_cast<uint64_t>(BinaryInteger(column));
+        break;
+    }
+    return;
+  }
+  const auto* text = PQgetvalue(result_, row_, column);
   if (text == nullptr) {
     return;
   }
@@ -156,7 +450,11 @@ void PostgresStatement::GetValue(int column, std::string& value) const {
   if (result_ == nullptr) {
     throw std::runtime_error("No statement result is found. Invalid use.");
   }
-  const auto* text = PQgetvalue(result_, 0, column);
+  if (IsBinary(column)) {
+    value = BinaryText(column);
+    return;
+  }
+  const auto* text = PQgetvalue(result_, row_, column);
   if (text == nullptr) {
     return;
   }
@@ -7,16 +7,42 @@
 #include <string>
 #include <stdexcept>
 #include <sstream>
+#include <type_traits>
 #include <vector>
 #include <libpq-fe.h>
 #include "ods/icolumn.h"
+#include "postgresparameters.h"
 
 namespace ods::detail {
 
+/** \brief Executes a query and steps through the result row by row.
+ *
+ * The result values are by default in the text format and parsed into the
+ * requested type. If the binary flag is set, the server sends the values
+ * in the binary format. The basic types (integers, floats, booleans,
+ * timestamps, byte arrays and text) are then decoded directly without any
+ * text parsing. Other types are returned as their raw bytes.
+ *
+ * By default, the rows are received in single-row mode, which means one
+ * result per row. If a fetch size is set, the query runs through a
+ * server-side cursor and the rows are fetched in blocks of that size. This
+ * reduces the number of results on large fetches. The cursor requires an
+ * active transaction, otherwise the single-row mode is used.
+ *
+ * The statement may also step through a complete result, for example a
+ * result from an asynchronous query. The result is then owned by the caller.
+ */
 class PostgresStatement final {
 public:
   PostgresStatement() = delete;
-  PostgresStatement(PGconn* connection, const std::string& sql);
+  PostgresStatement(PGconn* connection, const std::string& sql,
+                    bool binary = false, int fetch_size = 0);
+  /** \brief Executes a query with $1, $2... parameters. */
+  PostgresStatement(PGconn* connection, const std::string& sql,
+                    const PostgresParameters& parameters,
+                    bool binary = false, int fetch_size = 0);
+  /** \brief Steps through a complete result without any connection. */
+  explicit PostgresStatement(PGresult* result);
   virtual ~PostgresStatement();
 
   bool Step();
@@ -34,9 +60,29 @@ public:
   T Value(const std::string& column) const;
 
   [[nodiscard]] int GetColumnIndex(const std::string& column_name) const;
+  [[nodiscard]] bool IsNull(int column) const;
+  /** \brief Returns true if the column value is in the binary format. */
+  [[nodiscard]] bool IsBinary(int column) const;
+  /** \brief Returns the type OID of the column. */
+  [[nodiscard]] PostgresType ColumnType(int column) const;
 private:
   PGconn* connection_ = nullptr;
   PGresult* result_ = nullptr;
+  int row_ = 0; ///< Current row in the result.
+  bool binary_ = false;
+  int fetch_size_ = 0; ///< Rows per block. 0 = single-row mode.
+  std::string cursor_; ///< Cursor name if fetching in blocks.
+  std::string fetch_sql_;
+  bool end_of_cursor_ = false;
+
+  void DeclareCursor(const std::string& sql,
+                     const PostgresParameters& parameters);
+  bool StepCursor();
+
+  [[nodiscard]] int64_t BinaryInteger(int column) const;
+  [[nodiscard]] double BinaryFloat(int column) const;
+  [[nodiscard]] uint64_t BinaryTime(int column) const; ///< Nanoseconds since 1970
+  [[nodiscard]] std::string BinaryText(int column) const;
 };
 
 template <typename T>
@@ -45,7 +91,30 @@ void PostgresStatement::GetValue(int column, T& value) const {
   if (result_ == nullptr) {
     throw std::runtime_error("No statement result is found. Invalid use.");
   }
-  const auto* text = PQgetvalue(result_, 0, column);
+  if (IsBinary(column)) {
+    if constexpr (std::is_arithmetic_v<T>) {
+      switch (ColumnType(column)) {
+        case PostgresType::Real:
+        case PostgresType::Double:
+          value = static_cast<T>(BinaryFloat(column));
+          break;
+
+        case PostgresType::Timestamp:
+        case PostgresType::TimestampTz:
+          value = static_cast<T>(BinaryTime(column));
+          break;
+
+        default:
+          value = static_cast<T>(BinaryInteger(column));
+          break;
+      }
+    } else {
+      std::istringstream conv(BinaryText(column));
+      conv >> value;
+    }
+    return;
+  }
+  const auto* text = PQgetvalue(result_, row_, column);
   if (text != nullptr) {
     std::istringstream conv(text);
     conv >> value;
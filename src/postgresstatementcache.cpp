@@ -0,0 +1,80 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#include "postgresstatementcache.h"
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <util/logstream.h>
+
+using namespace util::log;
+
+namespace ods::detail {
+
+PostgresStatementCache::PostgresStatementCache(size_t max_statements)
+: max_statements_(max_statements) {
+}
+
+std::string PostgresStatementCache::Prepare(PGconn *connection,
+                                            const std::string &sql,
+                                            int nof_parameters,
+                                            const Oid* type_list) {
+  if (connection == nullptr) {
+    throw std::runtime_error("Database not open");
+  }
+  if (auto itr = cache_list_.find(sql); itr != cache_list_.end()) {
+    itr->second.last_used = ++use_counter_;
+    return itr->second.name;
+  }
+
+  if (max_statements_ > 0 && cache_list_.size() >= max_statements_) {
+    RemoveLeastUsed(connection);
+  }
+
+  std::ostringstream name;
+  name << "ods_stmt_" << ++name_counter_;
+  auto* result = PQprepare(connection, name.str().c_str(), sql.c_str(),
+                           nof_parameters, type_list);
+  const auto status = PQresultStatus(result);
+  if (status != PGRES_COMMAND_OK) {
+    const auto* msg = PQresultErrorMessage(result);
+    std::ostringstream err;
+    err << "Prepare statement failed. Error: "
+        << (msg != nullptr ? msg : "Bad response") << ", SQL: " << sql;
+    PQclear(result);
+    throw std::runtime_error(err.str());
+  }
+  PQclear(result);
+
+  auto& item = cache_list_[sql];
+  item.name = name.str();
+  item.last_used = ++use_counter_;
+  return item.name;
+}
+
+void PostgresStatementCache::Clear() {
+  cache_list_.clear();
+}
+
+void PostgresStatementCache::RemoveLeastUsed(PGconn *connection) {
+  const auto itr = std::ranges::min_element(cache_list_, [] (const auto& item1, const auto& item2) {
+    return item1.second.last_used < item2.second.last_used;
+  });
+  if (itr == cache_list_.end()) {
+    return;
+  }
+  const std::string sql = "DEALLOCATE " + itr->second.name;
+  auto* result = PQexec(connection, sql.c_str());
+  if (PQresultStatus(result) != PGRES_COMMAND_OK) {
+    // The statement is lost but it is not an error that stops the insert.
+    const auto* msg = PQresultErrorMessage(result);
+    LOG_DEBUG() << "Deallocate statement failed. Error: "
+                << (msg != nullptr ? msg : "") << ", SQL: " << sql;
+  }
+  PQclear(result);
+  cache_list_.erase(itr);
+}
+
+} // namespace ods::detail
@@ -0,0 +1,74 @@
+/*
+* Copyright 2024 Ingemar Hedvall
+* SPDX-License-Identifier: MIT
+*/
+
+#pragma once
+#include <cstdint>
+#include <map>
+#include <string>
+#include <libpq-fe.h>
+
+namespace ods::detail {
+
+/** \brief Cache of server-side prepared statements for one connection.
+ *
+ * The server parses and plans each SQL text that is sent as a query. A
+ * prepared statement is only parsed once and then executed with new
+ * parameter values. The cache maps the SQL text to the name of the
+ * prepared statement.
+ *
+ * The prepared statements belongs to the connection, so the cache must be
+ * cleared when the connection is closed. The least used statement is
+ * deallocated when the cache is full.
+ */
+class PostgresStatementCache final {
+public:
+  explicit PostgresStatementCache(size_t max_statements = 64);
+
+  PostgresStatementCache(const PostgresStatementCache&) = delete;
+  PostgresStatementCache& operator = (const PostgresStatementCache&) = delete;
+
+  /** \brief Returns the name of a prepared statement.
+   *
+   * The SQL text is prepared on the server the first time it is used.
+   * The function throws if the server fails to prepare the statement.
+   * @param connection Open connection.
+   * @param sql SQL text with $1, $2... parameters.
+   * @param nof_parameters Number of parameters.
+   * @param type_list Parameter type OID:s or null if the server decides.
+   * @return Name of the prepared statement.
+   */
+  [[nodiscard]] std::string Prepare(PGconn* connection, const std::string& sql,
+                                    int nof_parameters,
+                                    const Oid* type_list = nullptr);
+
+  /** \brief Forgets all statements. Called when the connection closes. */
+  void Clear();
+
+  [[nodiscard]] size_t Size() const {
+    return cache_list_.size();
+  }
+
+  void MaxStatements(size_t max_statements) {
+    max_statements_ = max_statements;
+  }
+  [[nodiscard]] size_t MaxStatements() const {
+    return max_statements_;
+  }
+
+private:
+  struct CacheItem {
+    std::string name;
+    uint64_t last_used = 0; ///< Used to remove the least recently used.
+  };
+
+  std::map<std::string, CacheItem> cache_list_;
+  size_t max_statements_ = 64;
+  uint64_t use_counter_ = 0;
+  uint64_t name_counter_ = 0;
+
+  void RemoveLeastUsed(PGconn* connection);
+};
+
+} // namespace ods::detail
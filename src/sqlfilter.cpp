@@ -46,10 +46,55 @@ const char *ConditionString(ods::SqlCondition condition) {
   return " = ";
 }
 
+// Conditions that compare with one value, which may be a parameter.
+bool IsSingleValue(ods::SqlCondition condition) {
+  switch (condition) {
+    case ods::SqlCondition::In:
+    case ods::SqlCondition::InIgnoreCase:
+    case ods::SqlCondition::NotIn:
+      return false;
+
+    default:
+      break;
+  }
+  return true;
+}
+
+// Returns the ISO date of an ISO date or ns since 1970 string.
+std::string MakeDateValue(const std::string& time_string) {
+  const bool is_nano_sec = !time_string.empty() && std::ranges::all_of(
+      time_string, [](const char in_byte) { return isdigit(in_byte); });
+  if (is_nano_sec) {
+    return util::time::NsToIsoTime(
+        boost::lexical_cast<uint64_t>(time_string));
+  }
+  return time_string;
+}
+
 } // end namespace
 
 namespace ods {
 
+void SqlFilter::AddWhereItem(const IColumn &column, SqlCondition condition,
+                             const std::string &value) {
+  SqlFilterItem item;
+  item.column_name = column.DatabaseName();
+  item.condition = condition;
+  if (column.DataType() == DataType::DtString) {
+    item.value = MakeSqlText(value);
+  } else if (column.DataType() == DataType::DtDate) {
+    item.value = MakeDateText(value);
+  } else {
+    item.value = value;
+  }
+  // A null value is kept as text as it isn't compared as a value.
+  if (IsSingleValue(condition) && !util::string::IEquals(value, "null")) {
+    item.parameter = column.DataType() == DataType::DtDate ?
+                     MakeDateValue(value) : value;
+  }
+  where_list_.push_back(std::move(item));
+}
+
 template <>
 void SqlFilter::AddWhere<bool>(const IColumn &column, SqlCondition condition,
                                const bool &value) {
@@ -275,8 +320,18 @@ std::string WildcardToSql(const std::string &wildcard) {
 }
 
 std::string SqlFilter::GetWhereStatement() const {
+  return MakeWhereStatement(nullptr, '?');
+}
+
+std::string SqlFilter::GetWhereStatement(std::vector<std::string> &value_list,
+                                         char prefix) const {
+  return MakeWhereStatement(&value_list, prefix);
+}
+
+std::string SqlFilter::MakeWhereStatement(std::vector<std::string>* value_list,
+                                          char prefix) const {
   if (where_list_.empty()) {
-    return GetOrderByStatement();
+    return GetOrderByStatement(value_list, prefix);
   }
 
   size_t count = 0;
@@ -299,17 +354,25 @@ std::string SqlFilter::GetWhereStatement() const {
 
     where << ConditionString(item.condition);
 
+    std::string value = item.value;
+    if (value_list != nullptr && item.parameter.has_value()) {
+      value_list->push_back(item.parameter.value());
+      value = prefix + std::to_string(value_list->size());
+    }
     if (ignore_case) {
-      where << "LOWER(" << item.value << ")";
+      where << "LOWER(" << value << ")";
     } else {
-      where << item.value;
+      where << value;
     }
 
     ++count;
   }
 
   if (!order_by_list_.empty()) {
-    where << " " << GetOrderByStatement(); // The function also adds limit
+    // The function also adds limit
+    where << " " << GetOrderByStatement(value_list, prefix);
+  } else if (!limit_list_.empty()) {
+    where << " " << GetLimitStatement(value_list, prefix);
   }
   return where.str();
 }
@@ -323,9 +386,10 @@ void SqlFilter::AddOrder(const IColumn &column, SqlCondition condition,
   order_by_list_.emplace_back(item);
 }
 
-std::string SqlFilter::GetOrderByStatement() const {
+std::string SqlFilter::GetOrderByStatement(
+    std::vector<std::string>* value_list, char prefix) const {
   if (order_by_list_.empty()) {
-    return GetLimitStatement();
+    return GetLimitStatement(value_list, prefix);
   }
   size_t count = 0;
   std::ostringstream order_by;
@@ -355,7 +419,7 @@ std::string SqlFilter::GetOrderByStatement() const {
     ++count;
   }
   if (!limit_list_.empty()) {
-    order_by << " " << GetLimitStatement();
+    order_by << " " << GetLimitStatement(value_list, prefix);
   }
   return order_by.str();
 }
@@ -365,19 +429,25 @@ void SqlFilter::AddLimit(SqlCondition condition, uint64_t value) {
   limit_list_.emplace_back(item);
 }
 
-std::string SqlFilter::GetLimitStatement() const {
+std::string SqlFilter::GetLimitStatement(std::vector<std::string>* value_list,
+                                         char prefix) const {
   if (limit_list_.empty()) {
     return "";
   }
   std::ostringstream limit;
   for (const auto &item : limit_list_) {
+    std::string value = item.value;
+    if (value_list != nullptr) {
+      value_list->push_back(item.value);
+      value = prefix + std::to_string(value_list->size());
+    }
     switch (item.condition) {
     case SqlCondition::LimitNofRows:
-      limit << "LIMIT " << item.value;
+      limit << "LIMIT " << value;
       break;
 
     case SqlCondition::LimitOffset:
-      limit << "OFFSET " << item.value;
+      limit << "OFFSET " << value;
       break;
 
     default:
@@ -401,13 +471,7 @@ std::string SqlFilter::MakeSqlText(const std::string &text) const {
 
 std::string SqlFilter::MakeDateText(const std::string &time_string) const {
   // Is either a ISO date string or ns since 1970
-  const bool is_nano_sec = std::ranges::all_of(
-      time_string, [](const char in_byte) { return isdigit(in_byte); });
-  if (is_nano_sec) {
-    return MakeSqlText(
-        util::time::NsToIsoTime(boost::lexical_cast<uint64_t>(time_string)));
-  }
-  return MakeSqlText(time_string);
+  return MakeSqlText(MakeDateValue(time_string));
 }
 
 bool SqlFilter::IsEmpty() const {
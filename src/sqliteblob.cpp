@@ -0,0 +1,92 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include "sqliteblob.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace ods::detail {
+
+SqliteBlob::SqliteBlob(sqlite3 *database, const std::string &table_name,
+                       const std::string &column_name, int64_t row_id,
+                       bool write)
+: database_(database),
+  table_name_(table_name),
+  column_name_(column_name) {
+  if (database_ == nullptr) {
+    throw std::runtime_error("Database is not open");
+  }
+  const auto open = sqlite3_blob_open(database_, "main", table_name_.c_str(),
+                                      column_name_.c_str(), row_id,
+                                      write ? 1 : 0, &blob_);
+  if (open != SQLITE_OK) {
+    std::ostringstream error;
+    error << "Open BLOB failed. Error: " << sqlite3_errmsg(database_)
+          << ", Table: " << table_name_ << ", Column: " << column_name_
+          << ", Row: " << row_id;
+    sqlite3_blob_close(blob_);
+    blob_ = nullptr;
+    throw std::runtime_error(error.str());
+  }
+}
+
+SqliteBlob::~SqliteBlob() {
+  sqlite3_blob_close(blob_);
+}
+
+size_t SqliteBlob::Size() const {
+  return blob_ != nullptr ? static_cast<size_t>(sqlite3_blob_bytes(blob_)) : 0;
+}
+
+void SqliteBlob::Read(size_t offset, std::span<uint8_t> buffer) const {
+  if (blob_ == nullptr) {
+    throw std::runtime_error("BLOB is not open");
+  }
+  if (buffer.empty()) {
+    return;
+  }
+  const auto read = sqlite3_blob_read(blob_, buffer.data(),
+                                      static_cast<int>(buffer.size()),
+                                      static_cast<int>(offset));
+  if (read != SQLITE_OK) {
+    std::ostringstream error;
+    error << "Read BLOB failed. Error: " << sqlite3_errstr(read)
+          << ", Table: " << table_name_ << ", Column: " << column_name_;
+    throw std::runtime_error(error.str());
+  }
+}
+
+void SqliteBlob::Write(size_t offset, std::span<const uint8_t> buffer) {
+  if (blob_ == nullptr) {
+    throw std::runtime_error("BLOB is not open");
+  }
+  if (buffer.empty()) {
+    return;
+  }
+  const auto write = sqlite3_blob_write(blob_, buffer.data(),
+                                        static_cast<int>(buffer.size()),
+                                        static_cast<int>(offset));
+  if (write != SQLITE_OK) {
+    std::ostringstream error;
+    error << "Write BLOB failed. Error: " << sqlite3_errstr(write)
+          << ", Table: " << table_name_ << ", Column: " << column_name_;
+    throw std::runtime_error(error.str());
+  }
+}
+
+void SqliteBlob::Reopen(int64_t row_id) {
+  if (blob_ == nullptr) {
+    throw std::runtime_error("BLOB is not open");
+  }
+  const auto reopen = sqlite3_blob_reopen(blob_, row_id);
+  if (reopen != SQLITE_OK) {
+    std::ostringstream error;
+    error << "Reopen BLOB failed. Error: " << sqlite3_errstr(reopen)
+          << ", Table: " << table_name_ << ", Column: " << column_name_
+          << ", Row: " << row_id;
+    throw std::runtime_error(error.str());
+  }
+}
+
+} // end namespace ods::detail
@@ -0,0 +1,55 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstdint>
+#include <span>
+#include <string>
+#include "sqlite3.h"
+
+namespace ods::detail {
+
+/** \brief Incremental read and write of a BLOB or TEXT cell.
+ *
+ * Wrapper around the sqlite3_blob interface. The handle reads or writes
+ * parts of a cell without loading the whole value into memory. Note that
+ * the size of the cell cannot be changed through the handle. Set the cell
+ * to a zeroblob() of the wanted size before writing to it.
+ *
+ * The handle is invalid after the row has been changed by an UPDATE or
+ * DELETE statement and all read and write calls then throws.
+ */
+class SqliteBlob final {
+ public:
+  /** \brief Default chunk size when streaming a cell. */
+  static constexpr size_t kChunkSize = 64 * 1024;
+
+  SqliteBlob(sqlite3* database, const std::string& table_name,
+             const std::string& column_name, int64_t row_id, bool write);
+  ~SqliteBlob();
+
+  SqliteBlob() = delete;
+  SqliteBlob(const SqliteBlob&) = delete;
+  SqliteBlob& operator = (const SqliteBlob&) = delete;
+
+  /** \brief Returns the cell size in bytes. */
+  [[nodiscard]] size_t Size() const;
+
+  /** \brief Reads buffer.size() bytes starting at offset. */
+  void Read(size_t offset, std::span<uint8_t> buffer) const;
+
+  /** \brief Writes the buffer starting at offset. */
+  void Write(size_t offset, std::span<const uint8_t> buffer);
+
+  /** \brief Moves the handle to another row in the same table. */
+  void Reopen(int64_t row_id);
+
+ private:
+  sqlite3* database_ = nullptr;
+  sqlite3_blob* blob_ = nullptr;
+  std::string table_name_;
+  std::string column_name_;
+};
+
+} // end namespace ods::detail
@@ -0,0 +1,239 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include "sqliteconnectionpool.h"
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+#include <util/logstream.h>
+
+using namespace util::log;
+
+namespace ods::detail {
+
+/** \brief Pool state that the leases reference.
+ *
+ * The leases hold a weak pointer to the state, so a lease that outlives
+ * the pool doesn't reference a deleted pool.
+ */
+struct SqlitePoolState {
+  explicit SqlitePoolState(const std::string& file)
+  : filename(file),
+    profile(SqliteProfile::Preset("wal")) {
+  }
+
+  const std::string filename;
+  SqliteProfile profile;
+
+  std::mutex lock;
+  std::condition_variable condition;
+  std::vector<std::unique_ptr<SqliteDatabase>> idle_reader_list;
+  size_t nof_readers = 0; ///< Number of created reader connections.
+  std::unique_ptr<SqliteDatabase> writer;
+  bool writer_busy = false;
+
+  void Release(std::unique_ptr<SqliteDatabase> database, bool is_writer);
+};
+
+void SqlitePoolState::Release(std::unique_ptr<SqliteDatabase> database,
+                              bool is_writer) {
+  if (database) {
+    try {
+      database->RollbackTransaction();
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Failed to end a pool transaction. Error: " << err.what()
+                  << ", File: " << filename;
+      database->Close(false);
+    }
+  }
+
+  std::lock_guard pool_lock(lock);
+  if (is_writer) {
+    if (database && database->IsOpen()) {
+      writer = std::move(database);
+    }
+    writer_busy = false;
+  } else if (database && database->IsOpen()) {
+    idle_reader_list.push_back(std::move(database));
+  } else if (nof_readers > 0) {
+    --nof_readers;
+  }
+  condition.notify_all();
+}
+
+SqliteConnectionLease::SqliteConnectionLease(
+    std::weak_ptr<SqlitePoolState> pool,
+    std::unique_ptr<SqliteDatabase> database, bool writer)
+: pool_(std::move(pool)),
+  database_(std::move(database)),
+  writer_(writer) {
+}
+
+SqliteConnectionLease::~SqliteConnectionLease() {
+  Release();
+}
+
+SqliteConnectionLease::SqliteConnectionLease(
+    SqliteConnectionLease &&lease) noexcept
+: pool_(std::move(lease.pool_)),
+  database_(std::move(lease.database_)),
+  writer_(lease.writer_) {
+  lease.pool_.reset();
+}
+
+SqliteConnectionLease &SqliteConnectionLease::operator=(
+    SqliteConnectionLease &&lease) noexcept {
+  if (this != &lease) {
+    Release();
+    pool_ = std::move(lease.pool_);
+    database_ = std::move(lease.database_);
+    writer_ = lease.writer_;
+    lease.pool_.reset();
+  }
+  return *this;
+}
+
+void SqliteConnectionLease::Release() {
+  if (database_) {
+    if (auto pool = pool_.lock(); pool) {
+      pool->Release(std::move(database_), writer_);
+    } else {
+      // The pool is deleted, so there is nothing to give the connection to.
+      database_->Close(false);
+    }
+  }
+  database_.reset();
+  pool_.reset();
+}
+
+SqliteConnectionPool::SqliteConnectionPool(const std::string &filename,
+                                           size_t max_readers)
+: filename_(filename),
+  max_readers_(max_readers < 1 ? 1 : max_readers),
+  state_(std::make_shared<SqlitePoolState>(filename)) {
+}
+
+SqliteConnectionPool::~SqliteConnectionPool() {
+  Close();
+}
+
+void SqliteConnectionPool::Profile(const SqliteProfile &profile) {
+  std::lock_guard lock(state_->lock);
+  state_->profile = profile;
+}
+
+SqliteProfile SqliteConnectionPool::Profile() const {
+  std::lock_guard lock(state_->lock);
+  return state_->profile;
+}
+
+SqliteConnectionLease SqliteConnectionPool::AcquireReader(
+    std::chrono::milliseconds timeout) {
+  auto& state = *state_;
+  std::unique_lock lock(state.lock);
+  const bool available = state.condition.wait_for(lock, timeout, [&] {
+    return !state.idle_reader_list.empty() || state.nof_readers < max_readers_;
+  });
+  if (!available) {
+    LOG_ERROR() << "Timeout waiting for a reader connection. File: "
+                << filename_;
+    return {};
+  }
+
+  if (!state.idle_reader_list.empty()) {
+    auto database = std::move(state.idle_reader_list.back());
+    state.idle_reader_list.pop_back();
+    return {state_, std::move(database), false};
+  }
+
+  // Open a new connection outside the lock.
+  ++state.nof_readers;
+  lock.unlock();
+  auto database = OpenConnection(false);
+  if (!database) {
+    lock.lock();
+    --state.nof_readers;
+    state.condition.notify_one();
+    return {};
+  }
+  return {state_, std::move(database), false};
+}
+
+SqliteConnectionLease SqliteConnectionPool::AcquireWriter(
+    std::chrono::milliseconds timeout) {
+  auto& state = *state_;
+  std::unique_lock lock(state.lock);
+  const bool available = state.condition.wait_for(lock, timeout, [&] {
+    return !state.writer_busy;
+  });
+  if (!available) {
+    LOG_ERROR() << "Timeout waiting for the writer connection. File: "
+                << filename_;
+    return {};
+  }
+  state.writer_busy = true;
+  auto database = std::move(state.writer);
+  if (!database) {
+    lock.unlock();
+    database = OpenConnection(true);
+    if (!database) {
+      lock.lock();
+      state.writer_busy = false;
+      state.condition.notify_all();
+      return {};
+    }
+  }
+  return {state_, std::move(database), true};
+}
+
+void SqliteConnectionPool::Close() {
+  std::vector<std::unique_ptr<SqliteDatabase>> close_list;
+  {
+    std::lock_guard lock(state_->lock);
+    state_->nof_readers -= state_->idle_reader_list.size();
+    close_list = std::move(state_->idle_reader_list);
+    state_->idle_reader_list.clear();
+    if (state_->writer) {
+      close_list.push_back(std::move(state_->writer));
+    }
+  }
+  for (auto& database : close_list) {
+    database->Close(false);
+  }
+  state_->condition.notify_all();
+}
+
+size_t SqliteConnectionPool::NofReaders() const {
+  std::lock_guard lock(state_->lock);
+  return state_->nof_readers;
+}
+
+std::unique_ptr<SqliteDatabase> SqliteConnectionPool::OpenConnection(
+    bool writer) const {
+  auto database = std::make_unique<SqliteDatabase>(filename_);
+  // The journal mode and auto vacuum cannot be set by a read-only connection.
+  database->Profile(writer ? Profile() : Profile().ReaderProfile());
+  database->Persistent(true);
+
+  // Each connection is only used by one thread at the time.
+  const int flags = (writer ? SQLITE_OPEN_READWRITE : SQLITE_OPEN_READONLY)
+      | SQLITE_OPEN_NOMUTEX;
+  try {
+    if (!database->OpenEx(flags)) {
+      LOG_ERROR() << "Failed to open a pool connection. File: " << filename_;
+      return {};
+    }
+    // The OpenEx() function starts a transaction. A reader transaction
+    // holds a snapshot of the database, so the connection should be idle
+    // until it is used.
+    database->CommitTransaction();
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to open a pool connection. Error: " << err.what()
+                << ", File: " << filename_;
+    return {};
+  }
+  return database;
+}
+
+} // end namespace ods::detail
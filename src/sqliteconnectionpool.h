@@ -0,0 +1,119 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <chrono>
+#include <memory>
+#include <string>
+#include "sqlitedatabase.h"
+#include "sqliteprofile.h"
+
+namespace ods::detail {
+
+struct SqlitePoolState;
+
+/** \brief Checked out connection from a connection pool.
+ *
+ * The lease gives back the connection to the pool when it goes out of scope.
+ * Any open transaction is rolled back at that point, so use a DatabaseGuard
+ * inside the lease scope to commit the changes. The lease may outlive its
+ * pool. The connection is then closed instead of given back.
+ */
+class SqliteConnectionLease final {
+ public:
+  SqliteConnectionLease() = default;
+  SqliteConnectionLease(std::weak_ptr<SqlitePoolState> pool,
+                        std::unique_ptr<SqliteDatabase> database, bool writer);
+  ~SqliteConnectionLease();
+
+  SqliteConnectionLease(SqliteConnectionLease&& lease) noexcept;
+  SqliteConnectionLease& operator = (SqliteConnectionLease&& lease) noexcept;
+  SqliteConnectionLease(const SqliteConnectionLease&) = delete;
+  SqliteConnectionLease& operator = (const SqliteConnectionLease&) = delete;
+
+  [[nodiscard]] bool IsWriter() const { return writer_; }
+
+  [[nodiscard]] SqliteDatabase& operator * () const { return *database_; }
+  [[nodiscard]] SqliteDatabase* operator -> () const {
+    return database_.get();
+  }
+  [[nodiscard]] explicit operator bool() const {
+    return static_cast<bool>(database_);
+  }
+
+  /** \brief Gives back the connection before the lease goes out of scope. */
+  void Release();
+ private:
+  std::weak_ptr<SqlitePoolState> pool_; ///< Expires with the pool.
+  std::unique_ptr<SqliteDatabase> database_;
+  bool writer_ = false;
+};
+
+/** \brief Pool of read-only connections and one writer connection.
+ *
+ * A SqliteDatabase object wraps one connection and should only be used by
+ * one thread at the time. The pool hands out up to N read-only connections
+ * and one writer connection, so report queries may run while another thread
+ * writes to the database. Each connection has its own statement cache.
+ *
+ * The connections are opened when they are first needed and are kept open
+ * until the pool is closed. The pool uses the WAL profile by default, which
+ * means that the readers doesn't block the writer and vice versa. The
+ * reader connections only use the connection settings of the profile, see
+ * SqliteProfile::ReaderProfile().
+ */
+class SqliteConnectionPool final {
+ public:
+  explicit SqliteConnectionPool(const std::string& filename,
+                                size_t max_readers = 4);
+  ~SqliteConnectionPool();
+
+  SqliteConnectionPool() = delete;
+  SqliteConnectionPool(const SqliteConnectionPool&) = delete;
+  SqliteConnectionPool& operator = (const SqliteConnectionPool&) = delete;
+
+  [[nodiscard]] const std::string& FileName() const { return filename_; }
+  [[nodiscard]] size_t MaxReaders() const { return max_readers_; }
+
+  /** \brief Sets the profile for new connections. Default is WAL. */
+  void Profile(const SqliteProfile& profile);
+  [[nodiscard]] SqliteProfile Profile() const;
+
+  /** \brief Returns a read-only connection.
+   *
+   * Waits for a free reader connection if all are checked out.
+   * @param timeout Max wait time.
+   * @return A lease that may be empty if the wait timed out or the open
+   * failed.
+   */
+  [[nodiscard]] SqliteConnectionLease AcquireReader(
+      std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+  /** \brief Returns the writer connection.
+   *
+   * Waits for the writer connection if it is checked out.
+   * @param timeout Max wait time.
+   * @return A lease that may be empty if the wait timed out or the open
+   * failed.
+   */
+  [[nodiscard]] SqliteConnectionLease AcquireWriter(
+      std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+  /** \brief Closes all idle connections. */
+  void Close();
+
+  /** \brief Number of opened reader connections. */
+  [[nodiscard]] size_t NofReaders() const;
+
+ private:
+  std::string filename_;
+  size_t max_readers_ = 4;
+
+  /** \brief Connection lists that are shared with the leases. */
+  std::shared_ptr<SqlitePoolState> state_;
+
+  [[nodiscard]] std::unique_ptr<SqliteDatabase> OpenConnection(bool writer) const;
+};
+
+} // end namespace ods::detail
@@ -5,6 +5,8 @@
 
 #include "sqlitedatabase.h"
 #include <filesystem>
+#include <fstream>
+#include <map>
 #include <sstream>
 #include <stdexcept>
 #include <thread>
@@ -25,6 +27,21 @@ using namespace util::string;
 using namespace util::time;
 namespace {
 
+// Number of virtual machine instructions between the timeout checks.
+constexpr int kProgressSteps = 1'000;
+// Number of backup restarts before the rest is copied in one step.
+constexpr size_t kMaxBackupRestarts = 3;
+
+// Transaction control shall always run to keep the transaction state.
+bool IsTransactionControl(const std::string& sql) {
+  std::istringstream temp(sql);
+  std::string command;
+  temp >> command;
+  return IEquals(command, "BEGIN") || IEquals(command, "COMMIT") ||
+         IEquals(command, "END") || IEquals(command, "ROLLBACK") ||
+         IEquals(command, "SAVEPOINT") || IEquals(command, "RELEASE");
+}
+
 int BusyHandler(void* , int nof_locks) {
   if (nof_locks < 1000) {
     std::this_thread::sleep_for(10ms);
@@ -33,42 +50,151 @@ int BusyHandler(void* , int nof_locks) {
   return 0;
 }
 
-void AddAttribute(const ods::IColumn& column,
-                  const ods::detail::SqliteStatement& select,
-                  int index,
-                  ods::IItem& row) {
+using DecodeFunction = void (*)(const ods::IColumn&,
+                                const ods::detail::SqliteStatement&, int,
+                                ods::IItem&);
+
+void DecodeInteger(const ods::IColumn& column,
+                   const ods::detail::SqliteStatement& select, int index,
+                   ods::IItem& row) {
+  row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                       select.Value<int64_t>(index)});
+}
+
+void DecodeFloat(const ods::IColumn& column,
+                 const ods::detail::SqliteStatement& select, int index,
+                 ods::IItem& row) {
+  row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                       select.Value<double>(index)});
+}
+
+void DecodeBoolean(const ods::IColumn& column,
+                   const ods::detail::SqliteStatement& select, int index,
+                   ods::IItem& row) {
+  row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                       select.Value<bool>(index)});
+}
+
+void DecodeBlob(const ods::IColumn& column,
+                const ods::detail::SqliteStatement& select, int index,
+                ods::IItem& row) {
+  row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                       select.Value<std::vector<uint8_t>>(index)});
+}
+
+void DecodeText(const ods::IColumn& column,
+                const ods::detail::SqliteStatement& select, int index,
+                ods::IItem& row) {
+  row.AppendAttribute({column.ApplicationName(), column.BaseName(),
+                       select.Value<std::string>(index)});
+}
+
+DecodeFunction GetDecodeFunction(ods::DataType type) {
   using namespace ods;
-  if (index < 0) {
-    return;
-  }
-  IAttribute attr(column.ApplicationName(), column.BaseName(), "");
-  switch (column.DataType()) {
+  switch (type) {
     case DataType::DtEnum:
     case DataType::DtId:
     case DataType::DtLongLong:
     case DataType::DtLong:
     case DataType::DtByte:
-    case DataType::DtShort:attr.Value(select.Value<int64_t>(index));
-      break;
+    case DataType::DtShort:
+      return DecodeInteger;
 
     case DataType::DtDouble:
-    case DataType::DtFloat:attr.Value(select.Value<double>(index));
-      break;
+    case DataType::DtFloat:
+      return DecodeFloat;
 
-    case DataType::DtBoolean:attr.Value(select.Value<bool>(index));
-      break;
+    case DataType::DtBoolean:
+      return DecodeBoolean;
 
     case DataType::DtBlob:
-    case DataType::DtByteString:attr.Value(select.Value<std::vector<uint8_t>>(index));
-      break;
+    case DataType::DtByteString:
+      return DecodeBlob;
 
     case DataType::DtExternalRef:
     case DataType::DtDate: // Stored as string in SQLite
     case DataType::DtString:
-    default:attr.Value(select.Value<std::string>(index));
-      break;
+    default:
+      return DecodeText;
+  }
+}
+
+/** \brief Binds a table column to a result column.
+ *
+ * The result column index and the decode function are resolved once per
+ * result set instead of once per row.
+ */
+struct ColumnBinding {
+  const ods::IColumn* column = nullptr;
+  int index = -1; ///< Result column index
+  DecodeFunction Decode = nullptr;
+};
+
+std::vector<ColumnBinding> MakeColumnBindings(const ods::ITable& table,
+                                   const ods::detail::SqliteStatement& select) {
+  std::map<std::string, int, util::string::IgnoreCase> result_list;
+  const int count = select.ColumnCount();
+  for (int index = 0; index < count; ++index) {
+    result_list.emplace(select.ColumnName(index), index);
+  }
+
+  std::vector<ColumnBinding> binding_list;
+  const auto& column_list = table.Columns();
+  binding_list.reserve(column_list.size());
+  for (const auto& column : column_list) {
+    if (column.DatabaseName().empty()) {
+      continue;
+    }
+    const auto itr = result_list.find(column.DatabaseName());
+    if (itr == result_list.cend()) {
+      continue;
+    }
+    binding_list.push_back({&column, itr->second,
+                            GetDecodeFunction(column.DataType())});
+  }
+  return binding_list;
+}
+
+void AddAttributes(const std::vector<ColumnBinding>& binding_list,
+                   const ods::detail::SqliteStatement& select,
+                   ods::IItem& row) {
+  row.AttributeList().reserve(binding_list.size());
+  for (const auto& binding : binding_list) {
+    binding.Decode(*binding.column, select, binding.index, row);
+  }
+}
+
+std::string MakeInsertSql(const ods::ITable& table) {
+  using namespace ods;
+  const auto &column_list = table.Columns();
+  // Note that all table should have an index (id) column but some
+  // doesn't so make fixes in case the column is missing.
+  const auto* id_column = table.GetColumnByBaseName("id");
+
+  int column_count = 1;
+  std::ostringstream insert;
+  std::ostringstream values;
+  insert << "INSERT INTO " << table.DatabaseName() << " (";
+  bool first = true;
+  for (const auto &col1: column_list) {
+    if (IEquals(col1.BaseName(), "id") || col1.DatabaseName().empty()) {
+      continue;
+    }
+    if (!first) {
+      insert << ",";
+      values << ",";
+    } else {
+      first = false;
+    }
+    insert << col1.DatabaseName();
+    values << "?" << column_count;
+    ++column_count;
+  }
+  insert << ") VALUES (" << values.str() << ")";
+  if (id_column != nullptr) {
+    insert << " RETURNING " << id_column->DatabaseName();
   }
-  row.AppendAttribute(attr);
+  return insert.str();
 }
 
 } // end namespace
@@ -120,6 +246,8 @@ bool SqliteDatabase::Open() {
 
     if (database_ != nullptr) {
       sqlite3_busy_handler(database_,BusyHandler, this);
+      sqlite3_progress_handler(database_, kProgressSteps, ProgressHandler,
+                               this);
       if (listen_ && listen_->IsActive()) {
         sqlite3_trace_v2(database_, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE
                                         | SQLITE_TRACE_ROW | SQLITE_TRACE_CLOSE,
@@ -135,6 +263,7 @@ bool SqliteDatabase::Open() {
       } else {
         ExecuteSql("PRAGMA foreign_keys = OFF");
       }
+      ApplyProfile();
 
       ExecuteSql("BEGIN TRANSACTION");
       transaction_ = true;
@@ -164,6 +293,7 @@ bool SqliteDatabase::OpenEx(int flags) {
   }
   if (database_ != nullptr) {
     sqlite3_busy_handler(database_,BusyHandler, this);
+    sqlite3_progress_handler(database_, kProgressSteps, ProgressHandler, this);
     if (listen_ && listen_->IsActive()) {
       sqlite3_trace_v2(database_, SQLITE_TRACE_STMT | SQLITE_TRACE_PROFILE
                                       | SQLITE_TRACE_ROW | SQLITE_TRACE_CLOSE,
@@ -174,6 +304,7 @@ bool SqliteDatabase::OpenEx(int flags) {
       sqlite3_trace_v2(database_, 0, nullptr, nullptr);
     }
     ExecuteSql("PRAGMA foreign_keys = ON");
+    ApplyProfile();
     ExecuteSql("BEGIN TRANSACTION");
     transaction_ = true;
   }
@@ -184,6 +315,7 @@ bool SqliteDatabase::Close(bool commit) {
   if (database_ == nullptr) {
     return true;
   }
+  statement_cache_.Clear();
   if (transaction_) {
     try {
       ExecuteSql(commit ? "COMMIT" : "ROLLBACK");
@@ -193,6 +325,7 @@ bool SqliteDatabase::Close(bool commit) {
     transaction_ = false;
   }
 
+  std::lock_guard lock(interrupt_lock_);
   const auto close = sqlite3_close_v2(database_);
   if (close != SQLITE_OK && database_ != nullptr) {
     LOG_ERROR() << "Failed to close the database. Error: "
@@ -206,6 +339,35 @@ bool SqliteDatabase::IsOpen() const {
   return database_ != nullptr;
 }
 
+void SqliteDatabase::BeginTransaction() {
+  if (InTransaction()) {
+    return;
+  }
+  ExecuteSql("BEGIN TRANSACTION");
+  transaction_ = true;
+}
+
+void SqliteDatabase::CommitTransaction() {
+  if (!InTransaction()) {
+    return;
+  }
+  ExecuteSql("COMMIT");
+  transaction_ = false;
+}
+
+void SqliteDatabase::RollbackTransaction() {
+  if (!InTransaction()) {
+    return;
+  }
+  transaction_ = false;
+  ExecuteSql("ROLLBACK");
+}
+
+bool SqliteDatabase::InTransaction() const {
+  // Note that SQLite may roll back a transaction by itself on some errors.
+  return database_ != nullptr && sqlite3_get_autocommit(database_) == 0;
+}
+
 bool SqliteDatabase::ExistDatabaseTable(const std::string &dbt_name)  {
   if (!IsOpen()) {
     throw std::runtime_error("The database is not open.");
@@ -248,10 +410,25 @@ int64_t SqliteDatabase::ExecuteSql(const std::string &sql) {
   if (database_ == nullptr) {
     throw std::runtime_error("Database not open");
   }
+  // A transaction control statement is neither interrupted nor timed out.
+  // It doesn't use a guard, so a pending interrupt is kept for the next
+  // statement.
+  const bool control = IsTransactionControl(sql);
+  std::optional<QueryGuard> guard;
+  if (control) {
+    std::lock_guard lock(interrupt_lock_);
+    control_statement_ = true;
+  } else {
+    guard.emplace(*this);
+  }
   exec_result_ = 0; // Variable updated by the callback.
   char* error = nullptr;
   sqlite3_exec(database_, sql.c_str(), ExecCallback, this,
                                  &error);
+  if (control) {
+    std::lock_guard lock(interrupt_lock_);
+    control_statement_ = false;
+  }
   if (error != nullptr) {
     std::ostringstream err;
     err << "SQL Execute error. Error: " << error << ", SQL:" << sql;
@@ -262,6 +439,54 @@ int64_t SqliteDatabase::ExecuteSql(const std::string &sql) {
   return exec_result_;
 }
 
+void SqliteDatabase::Interrupt() {
+  interrupted_ = true;
+  std::lock_guard lock(interrupt_lock_);
+  if (database_ != nullptr && !control_statement_) {
+    sqlite3_interrupt(database_);
+  }
+}
+
+SqliteDatabase::QueryGuard::QueryGuard(SqliteDatabase &database)
+: database_(database) {
+  if (database_.query_depth_++ > 0) {
+    return;
+  }
+  // The interrupt flag is not cleared here. An interrupt that arrives just
+  // before the statement starts shall abort the statement.
+  database_.deadline_ = database_.query_timeout_.count() > 0 ?
+      std::chrono::steady_clock::now() + database_.query_timeout_ :
+      std::chrono::steady_clock::time_point();
+}
+
+SqliteDatabase::QueryGuard::~QueryGuard() {
+  if (--database_.query_depth_ > 0) {
+    return;
+  }
+  database_.deadline_ = std::chrono::steady_clock::time_point();
+  database_.interrupted_ = false;
+}
+
+int SqliteDatabase::ProgressHandler(void *object) {
+  // A non-zero return value aborts the query with SQLITE_INTERRUPT.
+  const auto* database = static_cast<SqliteDatabase*>(object);
+  if (database == nullptr || database->query_depth_ <= 0 ||
+      database->control_statement_) {
+    return 0;
+  }
+  if (database->interrupted_) {
+    return 1;
+  }
+  const auto deadline = database->deadline_;
+  if (deadline != std::chrono::steady_clock::time_point() &&
+      std::chrono::steady_clock::now() > deadline) {
+    LOG_ERROR() << "Query timeout. Timeout: "
+                << database->query_timeout_.count() << " ms";
+    return 1;
+  }
+  return 0;
+}
+
 sqlite3 *SqliteDatabase::Sqlite3() {
   return database_;
 }
@@ -269,7 +494,22 @@ sqlite3 *SqliteDatabase::Sqlite3() {
 
 void SqliteDatabase::ConnectionInfo(const std::string &info) {
   IDatabase::ConnectionInfo(info); // May be changed by the filename function
-  FileName(info);
+  // Any profile settings after the file name, are removed from the info.
+  FileName(profile_.ParseConnectionInfo(info));
+}
+
+void SqliteDatabase::ApplyProfile() {
+  // A failing setting should not stop the database from opening. Some file
+  // systems doesn't support WAL and memory mapped files.
+  const auto pragma_list = profile_.MakePragmaList();
+  for (const auto& pragma : pragma_list) {
+    try {
+      ExecuteSql(pragma);
+    } catch (const std::exception& err) {
+      LOG_ERROR() << "Failed to apply the SQLite profile. Error: " << err.what()
+                  << ", File: " << FileName();
+    }
+  }
 }
 
 void SqliteDatabase::FileName(const std::string &filename) {
@@ -314,6 +554,7 @@ bool SqliteDatabase::Create(const IModel &model) {
 
 
 bool SqliteDatabase::ReadSvcEnumTable(IModel &model) {
+  const QueryGuard guard(*this);
   try {
     SqliteStatement select(database_, "SELECT * FROM SVCENUM");
     const auto enum_id = select.GetColumnIndex("ENUMID");
@@ -352,6 +593,7 @@ bool SqliteDatabase::ReadSvcEnumTable(IModel &model) {
   return true;
 }
 bool SqliteDatabase::ReadSvcEntTable(IModel &model) {
+  const QueryGuard guard(*this);
   try {
     SqliteStatement select(database_, "SELECT * FROM SVCENT");
     const auto app_id = select.GetColumnIndex("AID");
@@ -382,6 +624,7 @@ bool SqliteDatabase::ReadSvcEntTable(IModel &model) {
 }
 
 bool SqliteDatabase::ReadSvcAttrTable(IModel &model) {
+  const QueryGuard guard(*this);
   try {
     SqliteStatement select(database_, "SELECT * FROM SVCATTR");
     const auto app_id = select.GetColumnIndex("AID");
@@ -461,6 +704,7 @@ bool SqliteDatabase::ReadSvcAttrTable(IModel &model) {
 
 
 bool SqliteDatabase::ReadSvcRefTable(IModel &model) {
+  const QueryGuard guard(*this);
   model.GetRelationList().clear();
   if (!ExistDatabaseTable("SVCREF")) {
     return true;
@@ -509,16 +753,16 @@ void SqliteDatabase::FetchNameMap(const ITable &table, IdNameMap& dest_list, con
   std::ostringstream sql;
   sql << "SELECT " << column_id->DatabaseName() << "," << column_name->DatabaseName()
       << " FROM " << table.DatabaseName() ;
-  if (!filter.IsEmpty()) {
-    sql << " " << filter.GetWhereStatement();
-  }
 
-  SqliteStatement select(database_, sql.str());
+  const QueryGuard guard(*this);
+  auto statement = AcquireStatement(sql.str(), filter);
+  auto& select = *statement;
   for (bool more = select.Step(); more ; more = select.Step()) {
     const auto index = select.Value<int64_t>(0);
     const auto name = select.Value<std::string>(1);
     dest_list.insert({index, name});
   }
+  statement_cache_.Release(std::move(statement));
 }
 
 void SqliteDatabase::FetchItemList(const ITable &table, ItemList& dest_list, const SqlFilter& filter) {
@@ -532,28 +776,21 @@ void SqliteDatabase::FetchItemList(const ITable &table, ItemList& dest_list, con
 
   std::ostringstream sql;
   sql << "SELECT * FROM " << table.DatabaseName() ;
-  if (!filter.IsEmpty()) {
-    sql << " " << filter.GetWhereStatement();
-  }
 
-  SqliteStatement select(database_, sql.str());
+  const QueryGuard guard(*this);
+  auto statement = AcquireStatement(sql.str(), filter);
+  auto& select = *statement;
+  const auto binding_list = MakeColumnBindings(table, select);
   for (bool more = select.Step(); more ; more = select.Step()) {
-    const auto& column_list = table.Columns();
     auto row = std::make_unique<IItem>();
     if (!row) {
       throw std::runtime_error("Failed to allocate a row item.");
     }
     row->ApplicationId(table.ApplicationId());
-
-    for (const IColumn& column : column_list) {
-      if (column.DatabaseName().empty()) {
-        continue;
-      }
-      const int index = select.GetColumnIndex(column.DatabaseName());
-      AddAttribute(column, select, index, *row);
-    }
+    AddAttributes(binding_list, select, *row);
     dest_list.push_back(std::move(row));
   }
+  statement_cache_.Release(std::move(statement));
 }
 
 size_t SqliteDatabase::FetchItems(const ITable &table, const SqlFilter &filter,
@@ -568,30 +805,64 @@ size_t SqliteDatabase::FetchItems(const ITable &table, const SqlFilter &filter,
 
   std::ostringstream sql;
   sql << "SELECT * FROM " << table.DatabaseName() ;
-  if (!filter.IsEmpty()) {
-    sql << " " << filter.GetWhereStatement();
-  }
 
-  SqliteStatement select(database_, sql.str());
+  const QueryGuard guard(*this);
+  auto statement = AcquireStatement(sql.str(), filter);
+  auto& select = *statement;
+  const auto binding_list = MakeColumnBindings(table, select);
   for (bool more = select.Step(); more ; more = select.Step()) {
-    const auto& column_list = table.Columns();
-
     IItem row;
     row.ApplicationId(table.ApplicationId());
-    for (const IColumn& column : column_list) {
-      int index = select.GetColumnIndex(column.DatabaseName());
-      if (index < 0) {
-        continue;
-      }
-      AddAttribute(column, select, index, row);
-    }
+    AddAttributes(binding_list, select, row);
     OnItem(row);
     ++count;
   }
+  statement_cache_.Release(std::move(statement));
   return count;
 }
 
+ColumnDataList SqliteDatabase::FetchColumns(const ITable &table,
+    const SqlFilter &filter, const std::vector<std::string> &columns) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open.");
+  }
+  ColumnDataList data_list;
+  if (table.DatabaseName().empty()) {
+    return data_list;
+  }
+  const auto select_list = SelectColumns(table, columns);
+  if (select_list.empty()) {
+    return data_list;
+  }
+  data_list.reserve(select_list.size());
+
+  // Only select the requested columns.
+  std::ostringstream sql;
+  sql << "SELECT ";
+  for (size_t index = 0; index < select_list.size(); ++index) {
+    if (index > 0) {
+      sql << ",";
+    }
+    sql << select_list[index]->DatabaseName();
+    data_list.emplace_back(*select_list[index]);
+  }
+  sql << " FROM " << table.DatabaseName();
+
+  const QueryGuard guard(*this);
+  auto statement = AcquireStatement(sql.str(), filter);
+  auto& select = *statement;
+  const int nof_columns = static_cast<int>(data_list.size());
+  for (bool more = select.Step(); more ; more = select.Step()) {
+    for (int index = 0; index < nof_columns; ++index) {
+      select.AppendValue(index, data_list[index]);
+    }
+  }
+  statement_cache_.Release(std::move(statement));
+  return data_list;
+}
+
 bool SqliteDatabase::FetchModelEnvironment(IModel &model) {
+  const QueryGuard guard(*this);
 
   try {
       // Pre-fill with file information in case no environment row. This is actually the normal case.
@@ -758,6 +1029,10 @@ void SqliteDatabase::Vacuum() {
   }
 
   try {
+    // The auto vacuum mode of an existing database is changed by VACUUM.
+    if (!profile_.AutoVacuum().empty()) {
+      ExecuteSql("PRAGMA auto_vacuum = " + profile_.AutoVacuum());
+    }
     ExecuteSql("VACUUM");
   } catch (const std::exception& err) {
     sqlite3_close_v2(database_);
@@ -768,6 +1043,264 @@ void SqliteDatabase::Vacuum() {
   database_ = nullptr;
 }
 
+int64_t SqliteDatabase::AutoVacuum() {
+  return ExecuteSql("PRAGMA auto_vacuum");
+}
+
+int64_t SqliteDatabase::FreePages() {
+  return ExecuteSql("PRAGMA freelist_count");
+}
+
+void SqliteDatabase::IncrementalVacuum(int64_t max_pages) {
+  if (max_pages <= 0) {
+    return;
+  }
+  std::ostringstream sql;
+  sql << "PRAGMA incremental_vacuum(" << max_pages << ")";
+  ExecuteSql(sql.str());
+}
+
+void SqliteDatabase::Backup(SqliteDatabase &dest, int pages_per_step,
+                            const BackupProgress &OnProgress) {
+  if (dest.database_ == nullptr) {
+    std::ostringstream err;
+    err << "The backup database is not open. File: " << dest.FileName();
+    throw std::runtime_error(err.str());
+  }
+  // The destination cannot be used by a transaction during the backup.
+  dest.CommitTransaction();
+
+  // A closed database is copied through its own read-only connection.
+  sqlite3* source = database_;
+  const bool temporary = source == nullptr;
+  if (temporary) {
+    const auto open = sqlite3_open_v2(FileName().c_str(), &source,
+                                      SQLITE_OPEN_READONLY, nullptr);
+    if (open != SQLITE_OK || source == nullptr) {
+      std::ostringstream err;
+      err << "Failed to open the database. Error: " << sqlite3_errstr(open)
+          << ", File: " << FileName();
+      sqlite3_close_v2(source);
+      throw std::runtime_error(err.str());
+    }
+  }
+
+  auto* backup = sqlite3_backup_init(dest.database_, "main", source, "main");
+  if (backup == nullptr) {
+    std::ostringstream err;
+    err << "Failed to start the backup. Error: "
+        << sqlite3_errmsg(dest.database_) << ", File: " << FileName();
+    if (temporary) {
+      sqlite3_close_v2(source);
+    }
+    throw std::runtime_error(err.str());
+  }
+
+  int step = SQLITE_OK;
+  int remaining = -1;
+  size_t restarts = 0;
+  for (size_t locks = 0; locks < 1000; ) {
+    step = sqlite3_backup_step(backup, pages_per_step);
+    const int last_remaining = remaining;
+    remaining = sqlite3_backup_remaining(backup);
+    if (OnProgress) {
+      OnProgress(remaining, sqlite3_backup_pagecount(backup));
+    }
+    if (step == SQLITE_OK) {
+      if (last_remaining >= 0 && remaining >= last_remaining) {
+        // No progress, so another connection changed the source and the
+        // backup restarted. Copy the rest in one step after a few restarts,
+        // as it cannot be restarted while it holds the read lock.
+        if (++restarts >= kMaxBackupRestarts) {
+          pages_per_step = -1;
+        }
+      }
+      // Let other connections in between the steps.
+      locks = 0;
+      std::this_thread::sleep_for(1ms);
+    } else if (step == SQLITE_BUSY || step == SQLITE_LOCKED) {
+      ++locks;
+      std::this_thread::sleep_for(10ms);
+    } else {
+      break;
+    }
+  }
+  const auto finish = sqlite3_backup_finish(backup);
+  if (temporary) {
+    sqlite3_close_v2(source);
+  }
+
+  if (step != SQLITE_DONE || finish != SQLITE_OK) {
+    std::ostringstream err;
+    err << "The backup failed. Error: "
+        << sqlite3_errstr(step != SQLITE_DONE ? step : finish)
+        << ", File: " << FileName() << ", Backup: " << dest.FileName();
+    throw std::runtime_error(err.str());
+  }
+}
+
+void SqliteDatabase::Backup(const std::string &filename, int pages_per_step,
+                            const BackupProgress &OnProgress) {
+  SqliteDatabase dest(filename);
+  if (!dest.OpenEx()) {
+    std::ostringstream err;
+    err << "Failed to create the backup database. File: " << filename;
+    throw std::runtime_error(err.str());
+  }
+  Backup(dest, pages_per_step, OnProgress);
+  dest.Close(true);
+}
+
+size_t SqliteDatabase::BlobSize(const ITable &table,
+                                const std::string &column_name,
+                                int64_t row_id) {
+  const auto& column = GetBlobColumn(table, column_name);
+  const SqliteBlob blob(database_, table.DatabaseName(), column.DatabaseName(),
+                        row_id, false);
+  return blob.Size();
+}
+
+size_t SqliteDatabase::ReadBlob(const ITable &table,
+                                const std::string &column_name,
+                                int64_t row_id, std::ostream &dest,
+                                size_t chunk_size) {
+  const auto& column = GetBlobColumn(table, column_name);
+  const SqliteBlob blob(database_, table.DatabaseName(), column.DatabaseName(),
+                        row_id, false);
+  const size_t size = blob.Size();
+  std::vector<uint8_t> buffer(std::min(size, std::max(chunk_size,
+                                                      size_t{1})));
+  for (size_t offset = 0; offset < size; offset += buffer.size()) {
+    const auto bytes = std::min(buffer.size(), size - offset);
+    blob.Read(offset, {buffer.data(), bytes});
+    dest.write(reinterpret_cast<const char*>(buffer.data()),
+               static_cast<std::streamsize>(bytes));
+    if (!dest) {
+      throw std::runtime_error("Failed to write the BLOB to the stream");
+    }
+  }
+  return size;
+}
+
+void SqliteDatabase::ReadBlob(const ITable &table,
+                              const std::string &column_name, int64_t row_id,
+                              std::vector<uint8_t> &dest) {
+  const auto& column = GetBlobColumn(table, column_name);
+  const SqliteBlob blob(database_, table.DatabaseName(), column.DatabaseName(),
+                        row_id, false);
+  dest.resize(blob.Size());
+  blob.Read(0, dest);
+}
+
+size_t SqliteDatabase::ReadBlobToFile(const ITable &table,
+                                      const std::string &column_name,
+                                      int64_t row_id,
+                                      const std::string &filename,
+                                      size_t chunk_size) {
+  std::ofstream file(filename, std::ios_base::binary | std::ios_base::trunc);
+  if (!file.is_open()) {
+    std::ostringstream error;
+    error << "Failed to create the file. File: " << filename;
+    throw std::runtime_error(error.str());
+  }
+  return ReadBlob(table, column_name, row_id, file, chunk_size);
+}
+
+void SqliteDatabase::WriteBlob(const ITable &table,
+                               const std::string &column_name,
+                               int64_t row_id, std::istream &source,
+                               size_t size, size_t chunk_size) {
+  const auto& column = GetBlobColumn(table, column_name);
+  ResizeBlob(table, column, row_id, size);
+  SqliteBlob blob(database_, table.DatabaseName(), column.DatabaseName(),
+                  row_id, true);
+  std::vector<uint8_t> buffer(std::min(size, std::max(chunk_size,
+                                                      size_t{1})));
+  for (size_t offset = 0; offset < size; offset += buffer.size()) {
+    const auto bytes = std::min(buffer.size(), size - offset);
+    source.read(reinterpret_cast<char*>(buffer.data()),
+                static_cast<std::streamsize>(bytes));
+    if (source.gcount() != static_cast<std::streamsize>(bytes)) {
+      throw std::runtime_error("Failed to read the BLOB from the stream");
+    }
+    blob.Write(offset, {buffer.data(), bytes});
+  }
+}
+
+void SqliteDatabase::WriteBlob(const ITable &table,
+                               const std::string &column_name,
+                               int64_t row_id,
+                               std::span<const uint8_t> source,
+                               size_t chunk_size) {
+  const auto& column = GetBlobColumn(table, column_name);
+  ResizeBlob(table, column, row_id, source.size());
+  SqliteBlob blob(database_, table.DatabaseName(), column.DatabaseName(),
+                  row_id, true);
+  const size_t chunk = std::max(chunk_size, size_t{1});
+  for (size_t offset = 0; offset < source.size(); offset += chunk) {
+    blob.Write(offset, source.subspan(offset,
+                                      std::min(chunk, source.size() - offset)));
+  }
+}
+
+void SqliteDatabase::WriteBlobFromFile(const ITable &table,
+                                       const std::string &column_name,
+                                       int64_t row_id,
+                                       const std::string &filename,
+                                       size_t chunk_size) {
+  std::ifstream file(filename, std::ios_base::binary);
+  if (!file.is_open()) {
+    std::ostringstream error;
+    error << "Failed to open the file. File: " << filename;
+    throw std::runtime_error(error.str());
+  }
+  const auto size = std::filesystem::file_size(filename);
+  WriteBlob(table, column_name, row_id, file, static_cast<size_t>(size),
+            chunk_size);
+}
+
+const IColumn &SqliteDatabase::GetBlobColumn(const ITable &table,
+                                             const std::string &column_name) {
+  const auto* column = table.GetColumnByName(column_name);
+  if (column == nullptr) {
+    column = table.GetColumnByBaseName(column_name);
+  }
+  if (column == nullptr || column->DatabaseName().empty()
+      || table.DatabaseName().empty()) {
+    std::ostringstream error;
+    error << "The column doesn't exist in the database. Table: "
+          << table.ApplicationName() << ", Column: " << column_name;
+    throw std::runtime_error(error.str());
+  }
+  return *column;
+}
+
+void SqliteDatabase::ResizeBlob(const ITable &table, const IColumn &column,
+                                int64_t row_id, size_t size) {
+  const auto* column_id = table.GetColumnByBaseName("id");
+  if (column_id == nullptr) {
+    std::ostringstream error;
+    error << "The table doesn't have an ID column. Table: "
+          << table.ApplicationName();
+    throw std::runtime_error(error.str());
+  }
+  const QueryGuard guard(*this);
+  std::ostringstream sql;
+  sql << "UPDATE " << table.DatabaseName() << " SET " << column.DatabaseName()
+      << " = zeroblob(?1) WHERE " << column_id->DatabaseName() << " = ?2";
+  auto update = statement_cache_.Acquire(database_, sql.str());
+  update->SetValue(1, static_cast<int64_t>(size));
+  update->SetValue(2, row_id);
+  update->Step();
+  statement_cache_.Release(std::move(update));
+  if (sqlite3_changes(database_) != 1) {
+    std::ostringstream error;
+    error << "The row doesn't exist. Table: " << table.ApplicationName()
+          << ", ID: " << row_id;
+    throw std::runtime_error(error.str());
+  }
+}
+
 std::string SqliteDatabase::DataTypeToDbString(DataType type) {
   switch (type) {
   case ods::DataType::DtShort:
@@ -809,7 +1342,7 @@ void SqliteDatabase::InsertDumpRow(const ITable &table, IItem &row) {
   if (table.DatabaseName().empty() || column_list.empty() ) {
     return;
   }
-
+  const QueryGuard guard(*this);
 
   size_t parameter_count = 1; // Bind index of values
   std::ostringstream insert;
@@ -833,7 +1366,8 @@ void SqliteDatabase::InsertDumpRow(const ITable &table, IItem &row) {
   }
   insert << ") VALUES (" << values.str() << ")";
 
-  SqliteStatement statement(Sqlite3(),insert.str());
+  auto statement_ptr = statement_cache_.Acquire(database_, insert.str());
+  auto& statement = *statement_ptr;
   int value_count = 1;
   for (const auto &col2: column_list) {
     if (col2.DatabaseName().empty()) {
@@ -939,6 +1473,7 @@ void SqliteDatabase::InsertDumpRow(const ITable &table, IItem &row) {
     ++value_count;
   }
   statement.Step();
+  statement_cache_.Release(std::move(statement_ptr));
 }
 
 void SqliteDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& filter) {
@@ -947,47 +1482,71 @@ void SqliteDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& fi
     throw std::runtime_error("The database is not open");
   }
 
-
-  const auto &column_list = table.Columns();
-  // Note that all table should have an index (id) column but some
-  // doesn't so make fixes in case the column is missing.
-  const auto* id_column = table.GetColumnByBaseName("id");
-  if (table.DatabaseName().empty() || column_list.empty()) {
+  if (table.DatabaseName().empty() || table.Columns().empty()) {
     return;
   }
 
-  int column_count = 1;
-  std::ostringstream insert;
-  std::ostringstream values;
-  insert << "INSERT INTO " << table.DatabaseName() << " (";
-  bool first = true;
-  for (const auto &col1: column_list) {
-    if (IEquals(col1.BaseName(), "id") || col1.DatabaseName().empty()) {
-      continue;
-    }
-    if (!first) {
-      insert << ",";
-      values << ",";
-    } else {
-      first = false;
-    }
-    insert << col1.DatabaseName();
-    values << "?" << column_count;
-    ++column_count;
+  const QueryGuard guard(*this);
+  const TableLayout layout(table);
+  auto statement = statement_cache_.Acquire(database_, GetInsertSql(table));
+  BindInsertValues(layout, row, *statement);
+  statement->Step();
+  const auto idx = statement->Value<int64_t>(0);
+  row.ItemId(idx);
+  statement_cache_.Release(std::move(statement));
+}
+
+std::vector<int64_t> SqliteDatabase::InsertBatch(const ITable &table,
+                                                 std::span<IItem> row_list) {
+  if (!IsOpen()) {
+    throw std::runtime_error("The database is not open");
   }
-  insert << ") VALUES (" << values.str() << ")";
-  if (id_column != nullptr) {
-    insert << " RETURNING " << id_column->DatabaseName();
+
+  std::vector<int64_t> index_list;
+  if (table.DatabaseName().empty() || table.Columns().empty()
+      || row_list.empty()) {
+    return index_list;
+  }
+  index_list.reserve(row_list.size());
+  const QueryGuard guard(*this);
+
+  // The save point makes it possible to roll back the batch only.
+  ExecuteSql("SAVEPOINT insert_batch");
+  try {
+    // One prepared statement for all rows.
+    const TableLayout layout(table);
+    auto statement = statement_cache_.Acquire(database_, GetInsertSql(table));
+    for (IItem& row : row_list) {
+      BindInsertValues(layout, row, *statement);
+      statement->Step();
+      const auto idx = statement->Value<int64_t>(0);
+      row.ItemId(idx);
+      index_list.push_back(idx);
+      statement->Reset();
+    }
+    statement_cache_.Release(std::move(statement));
+  } catch (const std::exception&) {
+    ExecuteSql("ROLLBACK TO SAVEPOINT insert_batch");
+    ExecuteSql("RELEASE SAVEPOINT insert_batch");
+    throw;
   }
+  ExecuteSql("RELEASE SAVEPOINT insert_batch");
+  return index_list;
+}
 
-  // Bind all columns except any id column
-  SqliteStatement statement(Sqlite3(), insert.str());
+void SqliteDatabase::BindInsertValues(const TableLayout &layout,
+                                      const IItem &row,
+                                      SqliteStatement &statement) const {
+  // Bind all columns except any id column. The attributes are mapped once
+  // instead of a name search per column.
+  const auto attr_list = layout.MapItem(row);
   int value_count = 1;
-  for (const auto &col2: column_list) {
+  for (size_t ordinal = 0; ordinal < layout.NofColumns(); ++ordinal) {
+    const auto& col2 = layout.Column(ordinal);
     if (IEquals(col2.BaseName(), "id") || col2.DatabaseName().empty()) {
       continue;
     }
-    const auto *attr = row.GetAttribute(col2.ApplicationName());
+    const auto *attr = attr_list[ordinal];
     if (attr != nullptr) {
       // The user has set the item
       switch (col2.DataType()) {
@@ -1085,12 +1644,8 @@ void SqliteDatabase::Insert(const ITable &table, IItem &row, const SqlFilter& fi
     }
     ++value_count;
   }
-  statement.Step();
-  const auto idx = statement.Value<int64_t>(0);
-  row.ItemId(idx);
 }
 
-
 void SqliteDatabase::Update(const ITable &table, IItem &row, const SqlFilter& filter) {
 
   if (!IsOpen()) {
@@ -1101,6 +1656,7 @@ void SqliteDatabase::Update(const ITable &table, IItem &row, const SqlFilter& fi
   if (table.DatabaseName().empty() || column_list.empty()) {
     return;
   }
+  const QueryGuard guard(*this);
 
   int column_count = 1;
   std::ostringstream update;
@@ -1127,12 +1683,14 @@ void SqliteDatabase::Update(const ITable &table, IItem &row, const SqlFilter& fi
     update << col1.DatabaseName() << "=?" << column_count; // Bind value
     ++column_count;
   }
-  update << " " << filter.GetWhereStatement();
+
+  // The WHERE values are bound after the SET values.
+  auto statement_ptr = AcquireStatement(update.str(), filter, column_count);
+  auto& statement = *statement_ptr;
 
   // Bind input values.
   const uint64_t now = TimeStampToNs();
   int value_count = 1;
-  SqliteStatement statement(Sqlite3(), update.str());
   for (const auto &col2: column_list) {
     if (col2.DatabaseName().empty() || IEquals(col2.BaseName(), "id")) {
       continue;
@@ -1214,6 +1772,41 @@ void SqliteDatabase::Update(const ITable &table, IItem &row, const SqlFilter& fi
   }
 
   statement.Step();
+  statement_cache_.Release(std::move(statement_ptr));
+}
+
+std::unique_ptr<SqliteStatement> SqliteDatabase::AcquireStatement(
+    const std::string& sql, const SqlFilter& filter, int first_parameter) {
+  if (filter.IsEmpty()) {
+    return statement_cache_.Acquire(database_, sql);
+  }
+  // The values before the first filter parameter are bound by the caller.
+  std::vector<std::string> value_list(first_parameter - 1);
+  const std::string where = filter.GetWhereStatement(value_list, '?');
+  auto statement = statement_cache_.Acquire(database_, sql + " " + where);
+  for (int index = first_parameter;
+       index <= static_cast<int>(value_list.size()); ++index) {
+    statement->SetValue(index, value_list[index - 1]);
+  }
+  return statement;
+}
+
+const std::string& SqliteDatabase::GetInsertSql(const ITable& table) {
+  auto& insert = insert_sql_list_[table.DatabaseName()];
+  // The SQL is rebuilt only if the table columns have been changed.
+  const auto& column_list = table.Columns();
+  bool same = insert.column_list.size() == column_list.size();
+  for (size_t index = 0; same && index < column_list.size(); ++index) {
+    same = insert.column_list[index] == column_list[index].DatabaseName();
+  }
+  if (!same || insert.sql.empty()) {
+    insert.column_list.clear();
+    for (const auto& column : column_list) {
+      insert.column_list.push_back(column.DatabaseName());
+    }
+    insert.sql = MakeInsertSql(table);
+  }
+  return insert.sql;
 }
 
 } // end namespace ods
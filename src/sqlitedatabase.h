@@ -4,20 +4,36 @@
  */
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <functional>
+#include <iosfwd>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <vector>
 #include "sqlite3.h"
 #include <util/utilfactory.h>
 #include "ods/idatabase.h"
 #include "ods/imodel.h"
 #include "ods/iitem.h"
 #include "ods/sqlfilter.h"
+#include "ods/tablelayout.h"
+#include "sqlitestatementcache.h"
+#include "sqliteprofile.h"
+#include "sqliteblob.h"
 
 namespace ods::detail {
 
+class SqliteStatement;
 
 class SqliteDatabase : public IDatabase {
  public:
+  /** \brief Backup progress callback with remaining and total page count. */
+  using BackupProgress = std::function<void(int remaining, int page_count)>;
+
   SqliteDatabase();
   explicit SqliteDatabase(const std::string& filename);
   ~SqliteDatabase() override;
@@ -27,15 +43,29 @@ class SqliteDatabase : public IDatabase {
   [[nodiscard]] const std::string& FileName() const;
   void FileName(const std::string& filename);
 
+  /** \brief Sets the performance profile that is applied at open. */
+  void Profile(const SqliteProfile& profile) { profile_ = profile; }
+  [[nodiscard]] const SqliteProfile& Profile() const { return profile_; }
+
   bool Open() override;
   [[nodiscard]] bool OpenEx(int flags = SQLITE_OPEN_CREATE | SQLITE_OPEN_READWRITE);
   bool Close(bool commit) override;
   [[nodiscard]] bool IsOpen() const override;
+
+  void BeginTransaction() override;
+  void CommitTransaction() override;
+  void RollbackTransaction() override;
+  [[nodiscard]] bool InTransaction() const override;
+
+  /** \brief Aborts the running query with sqlite3_interrupt(). */
+  void Interrupt() override;
   bool ExistDatabaseTable(const std::string& dbt_name) override;
 
   [[nodiscard]] bool Create(const IModel& model) override;
 
   void Insert(const ITable& table, IItem& row, const SqlFilter& filter) override;
+  std::vector<int64_t> InsertBatch(const ITable& table,
+                                   std::span<IItem> row_list) override;
   void Update(const ITable& table, IItem& row, const SqlFilter& filter) override;
 
   int64_t ExecuteSql(const std::string& sql) override;
@@ -46,8 +76,82 @@ class SqliteDatabase : public IDatabase {
                      const SqlFilter& filter) override;
   size_t FetchItems(const ITable &table, const SqlFilter &filter,
                   std::function<void(IItem &)> OnItem) override;
+  [[nodiscard]] ColumnDataList FetchColumns(const ITable& table,
+      const SqlFilter& filter,
+      const std::vector<std::string>& columns) override;
   void Vacuum() override;
 
+  /** \brief Returns the auto vacuum mode, 0 = NONE, 1 = FULL, 2 = INCREMENTAL.
+   *
+   * A database that was created without auto vacuum, is converted by the
+   * Vacuum() function if the profile defines an auto vacuum mode.
+   */
+  [[nodiscard]] int64_t AutoVacuum();
+  /** \brief Returns number of unused pages in the database file. */
+  [[nodiscard]] int64_t FreePages();
+  /** \brief Removes up to max_pages unused pages from the database file.
+   *
+   * Requires the INCREMENTAL auto vacuum mode. The function doesn't close
+   * the database as the Vacuum() function does, so it can be called between
+   * inserts.
+   */
+  void IncrementalVacuum(int64_t max_pages);
+
+  /** \brief Online backup of this database into another database.
+   *
+   * Copies the database pages in steps. The source is only locked during a
+   * step, so other connections may write to the database between the steps.
+   * If another connection changes the source, the backup restarts
+   * automatically. After a few restarts, the remaining pages are copied in
+   * one step, which blocks writers in rollback journal mode but not in WAL
+   * mode. If this database isn't open, a temporary read-only
+   * connection is used. The destination must be open and is overwritten.
+   * Use the ":memory:" file name for an in-memory copy. The function throws
+   * on errors.
+   * @param dest Open destination database.
+   * @param pages_per_step Number of pages per step. Negative copies all.
+   * @param OnProgress Optional callback that is called after each step.
+   */
+  void Backup(SqliteDatabase& dest, int pages_per_step = 1'000,
+              const BackupProgress& OnProgress = {});
+
+  /** \brief Online backup of this database into a file. */
+  void Backup(const std::string& filename, int pages_per_step = 1'000,
+              const BackupProgress& OnProgress = {});
+
+  /** \brief Returns the size in bytes of a BLOB or TEXT cell.
+   *
+   * The blob functions below reads or writes a cell in chunks without
+   * loading the whole value into memory. The column is given by its
+   * application or base name and the row by its ID (SQLite rowid).
+   */
+  [[nodiscard]] size_t BlobSize(const ITable& table,
+                                const std::string& column_name,
+                                int64_t row_id);
+  size_t ReadBlob(const ITable& table, const std::string& column_name,
+                  int64_t row_id, std::ostream& dest,
+                  size_t chunk_size = SqliteBlob::kChunkSize);
+  void ReadBlob(const ITable& table, const std::string& column_name,
+                int64_t row_id, std::vector<uint8_t>& dest);
+  size_t ReadBlobToFile(const ITable& table, const std::string& column_name,
+                        int64_t row_id, const std::string& filename,
+                        size_t chunk_size = SqliteBlob::kChunkSize);
+
+  /** \brief Replaces a cell with size bytes from a stream.
+   *
+   * The cell is first resized to a zero filled blob, then the source is
+   * copied in chunks.
+   */
+  void WriteBlob(const ITable& table, const std::string& column_name,
+                 int64_t row_id, std::istream& source, size_t size,
+                 size_t chunk_size = SqliteBlob::kChunkSize);
+  void WriteBlob(const ITable& table, const std::string& column_name,
+                 int64_t row_id, std::span<const uint8_t> source,
+                 size_t chunk_size = SqliteBlob::kChunkSize);
+  void WriteBlobFromFile(const ITable& table, const std::string& column_name,
+                         int64_t row_id, const std::string& filename,
+                         size_t chunk_size = SqliteBlob::kChunkSize);
+
 
   sqlite3* Sqlite3();
 
@@ -66,6 +170,43 @@ protected:
       util::UtilFactory::CreateListen("ListenProxy", "LISSQLITE");
   size_t row_count_ = 0;
   int64_t exec_result_ = 0; ///< Resulting value from an ExecuteSql
+  SqliteStatementCache statement_cache_; ///< Prepared statements
+
+  /** \brief Compiled INSERT SQL and the columns it was made from. */
+  struct InsertSql {
+    std::vector<std::string> column_list; ///< Database column names.
+    std::string sql;
+  };
+  /** \brief Database table name to its INSERT SQL. */
+  std::map<std::string, InsertSql> insert_sql_list_;
+  SqliteProfile profile_; ///< PRAGMA settings applied at open
+
+  std::mutex interrupt_lock_; ///< Protects the handle while interrupting.
+  std::atomic<bool> interrupted_ = false;
+  /** True while a transaction control statement runs. */
+  std::atomic<bool> control_statement_ = false;
+  /** Query deadline. Default value means no timeout. */
+  std::chrono::steady_clock::time_point deadline_;
+  int query_depth_ = 0; ///< Number of nested query guards.
+
+  /** \brief Arms the query timeout while a statement runs.
+   *
+   * The outer guard sets the deadline. The deadline and the interrupt flag
+   * are reset when the guard goes out of scope, so a statement never runs
+   * under the deadline of an earlier statement. An interrupt is only
+   * cleared after the statement it aborted has ended.
+   */
+  class QueryGuard final {
+   public:
+    explicit QueryGuard(SqliteDatabase& database);
+    ~QueryGuard();
+
+    QueryGuard() = delete;
+    QueryGuard(const QueryGuard&) = delete;
+    QueryGuard& operator = (const QueryGuard&) = delete;
+   private:
+    SqliteDatabase& database_;
+  };
 
 
   bool ReadSvcEnumTable(IModel& model) override;
@@ -75,8 +216,32 @@ protected:
 
   bool FetchModelEnvironment(IModel& model) override;
 
+  void ApplyProfile();
+  [[nodiscard]] static const IColumn& GetBlobColumn(
+      const ITable& table, const std::string& column_name);
+  void ResizeBlob(const ITable& table, const IColumn& column, int64_t row_id,
+                  size_t size);
+  void BindInsertValues(const TableLayout& layout, const IItem& row,
+                        SqliteStatement& statement) const;
+
+  /** \brief Returns a cached statement with bound filter values.
+   *
+   * The filter values are bound as parameters, so the SQL text is the same
+   * for all calls that only differs in the values. The returned statement
+   * shall be given back to the statement cache.
+   * @param sql SQL text without the WHERE statement.
+   * @param filter The filter is appended to the SQL text.
+   * @param first_parameter Number of the first filter parameter.
+   * @return A statement ready to be stepped.
+   */
+  [[nodiscard]] std::unique_ptr<SqliteStatement> AcquireStatement(
+      const std::string& sql, const SqlFilter& filter,
+      int first_parameter = 1);
+  [[nodiscard]] const std::string& GetInsertSql(const ITable& table);
+
   static int TraceCallback(unsigned mask, void* context,  void* arg1,
                            void* arg2);
+  static int ProgressHandler(void* object);
   static int ExecCallback(void* object, int rows, char** value_list,
                           char** column_list);
 };
@@ -0,0 +1,235 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include "sqliteprofile.h"
+#include <array>
+#include <algorithm>
+#include <cctype>
+#include <sstream>
+#include <string_view>
+#include <util/logstream.h>
+#include <util/stringutil.h>
+
+using namespace util::log;
+using namespace util::string;
+
+namespace {
+
+constexpr std::array<std::string_view, 6> kJournalModeList = {
+    "DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"
+};
+
+constexpr std::array<std::string_view, 4> kSynchronousList = {
+    "OFF", "NORMAL", "FULL", "EXTRA"
+};
+
+constexpr std::array<std::string_view, 3> kTempStoreList = {
+    "DEFAULT", "FILE", "MEMORY"
+};
+
+constexpr std::array<std::string_view, 3> kAutoVacuumList = {
+    "NONE", "FULL", "INCREMENTAL"
+};
+
+template <size_t N>
+std::string FindMode(const std::string& mode,
+                     const std::array<std::string_view, N>& mode_list) {
+  std::string upper = Trim(mode);
+  std::ranges::transform(upper, upper.begin(), [] (unsigned char in) {
+    return static_cast<char>(std::toupper(in));
+  });
+  const auto itr = std::ranges::find(mode_list, upper);
+  return itr != mode_list.cend() ? upper : std::string();
+}
+
+bool ToInteger(const std::string& text, int64_t& value) {
+  try {
+    size_t pos = 0;
+    value = std::stoll(text, &pos);
+    return pos == text.size();
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+} // end namespace
+
+namespace ods::detail {
+
+SqliteProfile SqliteProfile::Preset(const std::string &name) {
+  SqliteProfile profile;
+  if (IEquals(name, "wal")) {
+    profile.journal_mode_ = "WAL";
+    profile.synchronous_ = "NORMAL";
+    profile.temp_store_ = "MEMORY";
+  } else if (IEquals(name, "read-mostly")) {
+    profile.journal_mode_ = "WAL";
+    profile.synchronous_ = "NORMAL";
+    profile.cache_size_ = -64'000; // 64 MB
+    profile.mmap_size_ = 256'000'000;
+    profile.temp_store_ = "MEMORY";
+  } else if (IEquals(name, "bulk-load")) {
+    profile.journal_mode_ = "WAL";
+    profile.synchronous_ = "OFF";
+    profile.cache_size_ = -256'000; // 256 MB
+    profile.temp_store_ = "MEMORY";
+  } else if (!name.empty() && !IEquals(name, "default")) {
+    LOG_ERROR() << "Unknown SQLite profile. Using default profile. Profile: "
+                << name;
+    return profile;
+  }
+  profile.name_ = name.empty() ? "default" : name;
+  return profile;
+}
+
+std::string SqliteProfile::ParseConnectionInfo(const std::string &info) {
+  const auto first = info.find(';');
+  if (first == std::string::npos) {
+    return info;
+  }
+
+  std::istringstream option_list(info.substr(first + 1));
+  std::string option;
+  while (std::getline(option_list, option, ';')) {
+    if (Trim(option).empty()) {
+      continue;
+    }
+    const auto equal = option.find('=');
+    const std::string key = Trim(option.substr(0, equal));
+    const std::string value = equal == std::string::npos ?
+        std::string() : Trim(option.substr(equal + 1));
+    if (!SetOption(key, value)) {
+      LOG_ERROR() << "Invalid SQLite connection option. Option: " << option;
+    }
+  }
+  return Trim(info.substr(0, first));
+}
+
+bool SqliteProfile::SetOption(const std::string &key,
+                              const std::string &value) {
+  if (IEquals(key, "profile")) {
+    const auto preset = Preset(value);
+    if (!IEquals(preset.Name(), value)) {
+      return false;
+    }
+    *this = preset;
+    return true;
+  }
+
+  if (IEquals(key, "journal_mode")) {
+    const auto mode = FindMode(value, kJournalModeList);
+    if (mode.empty()) {
+      return false;
+    }
+    journal_mode_ = mode;
+    return true;
+  }
+
+  if (IEquals(key, "synchronous")) {
+    const auto mode = FindMode(value, kSynchronousList);
+    if (mode.empty()) {
+      return false;
+    }
+    synchronous_ = mode;
+    return true;
+  }
+
+  if (IEquals(key, "temp_store")) {
+    const auto mode = FindMode(value, kTempStoreList);
+    if (mode.empty()) {
+      return false;
+    }
+    temp_store_ = mode;
+    return true;
+  }
+
+  if (IEquals(key, "auto_vacuum")) {
+    const auto mode = FindMode(value, kAutoVacuumList);
+    if (mode.empty()) {
+      return false;
+    }
+    auto_vacuum_ = mode;
+    return true;
+  }
+
+  int64_t size = 0;
+  if (IEquals(key, "cache_size") && ToInteger(value, size)) {
+    cache_size_ = size;
+    return true;
+  }
+
+  if (IEquals(key, "mmap_size") && ToInteger(value, size) && size >= 0) {
+    mmap_size_ = size;
+    return true;
+  }
+  return false;
+}
+
+void SqliteProfile::JournalMode(const std::string &mode) {
+  if (!SetOption("journal_mode", mode)) {
+    LOG_ERROR() << "Invalid SQLite journal mode. Mode: " << mode;
+  }
+}
+
+void SqliteProfile::Synchronous(const std::string &mode) {
+  if (!SetOption("synchronous", mode)) {
+    LOG_ERROR() << "Invalid SQLite synchronous mode. Mode: " << mode;
+  }
+}
+
+void SqliteProfile::TempStore(const std::string &mode) {
+  if (!SetOption("temp_store", mode)) {
+    LOG_ERROR() << "Invalid SQLite temp store mode. Mode: " << mode;
+  }
+}
+
+void SqliteProfile::AutoVacuum(const std::string &mode) {
+  if (!SetOption("auto_vacuum", mode)) {
+    LOG_ERROR() << "Invalid SQLite auto vacuum mode. Mode: " << mode;
+  }
+}
+
+bool SqliteProfile::IsDefault() const {
+  return journal_mode_.empty() && synchronous_.empty() &&
+    !cache_size_.has_value() && !mmap_size_.has_value() &&
+    temp_store_.empty() && auto_vacuum_.empty();
+}
+
+SqliteProfile SqliteProfile::ReaderProfile() const {
+  SqliteProfile profile = *this;
+  profile.journal_mode_.clear();
+  profile.synchronous_.clear();
+  profile.auto_vacuum_.clear();
+  return profile;
+}
+
+std::vector<std::string> SqliteProfile::MakePragmaList() const {
+  std::vector<std::string> pragma_list;
+  // The auto vacuum mode must be set before any table is created.
+  if (!auto_vacuum_.empty()) {
+    pragma_list.emplace_back("PRAGMA auto_vacuum = " + auto_vacuum_);
+  }
+  // The journal mode cannot be changed inside a transaction, so it is
+  // applied first.
+  if (!journal_mode_.empty()) {
+    pragma_list.emplace_back("PRAGMA journal_mode = " + journal_mode_);
+  }
+  if (!synchronous_.empty()) {
+    pragma_list.emplace_back("PRAGMA synchronous = " + synchronous_);
+  }
+  if (cache_size_.has_value()) {
+    pragma_list.emplace_back("PRAGMA cache_size = "
+                             + std::to_string(cache_size_.value()));
+  }
+  if (mmap_size_.has_value()) {
+    pragma_list.emplace_back("PRAGMA mmap_size = "
+                             + std::to_string(mmap_size_.value()));
+  }
+  if (!temp_store_.empty()) {
+    pragma_list.emplace_back("PRAGMA temp_store = " + temp_store_);
+  }
+  return pragma_list;
+}
+
+} // end namespace ods::detail
@@ -0,0 +1,118 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace ods::detail {
+
+/** \brief Performance settings that are applied when a SQLite database opens.
+ *
+ * The profile holds the PRAGMA settings that affect the performance of a
+ * connection. An unset value means that the SQLite default is used. The
+ * profile is normally selected by name (preset) but each setting can be
+ * changed individually.
+ *
+ * The profile may also be defined in the connection string by appending
+ * key=value pairs to the file name, separated by ';'. Example:
+ * "c:/temp/eventlog.sqlite;profile=read-mostly;cache_size=-32000".
+ *
+ * <ul>
+ * <li> default: No change of the SQLite settings.
+ * <li> wal: WAL journal mode and normal synchronous mode. Readers and a
+ * writer do not block each other.
+ * <li> read-mostly: As WAL but with a large page cache and memory mapped I/O.
+ * <li> bulk-load: As WAL but without sync and with a large page cache. Should
+ * only be used when the database can be rebuilt after a power failure.
+ * </ul>
+ */
+class SqliteProfile final {
+ public:
+  /** \brief Returns a predefined profile.
+   *
+   * Returns a predefined profile. An unknown name returns the default
+   * profile.
+   * @param name Preset name as default, wal, read-mostly or bulk-load.
+   * @return Profile with the preset settings.
+   */
+  [[nodiscard]] static SqliteProfile Preset(const std::string& name);
+
+  /** \brief Splits a connection string into a file name and profile settings.
+   *
+   * @param info Connection string as file;key=value;key=value.
+   * @return The file name part of the connection string.
+   */
+  [[nodiscard]] std::string ParseConnectionInfo(const std::string& info);
+
+  /** \brief Sets a profile setting by its key name.
+   *
+   * The key is the PRAGMA name or 'profile' which selects a preset.
+   * @param key Setting name.
+   * @param value Setting value.
+   * @return False if the key or value is invalid.
+   */
+  bool SetOption(const std::string& key, const std::string& value);
+
+  [[nodiscard]] const std::string& Name() const { return name_; }
+
+  void JournalMode(const std::string& mode);
+  [[nodiscard]] const std::string& JournalMode() const {
+    return journal_mode_;
+  }
+
+  void Synchronous(const std::string& mode);
+  [[nodiscard]] const std::string& Synchronous() const {
+    return synchronous_;
+  }
+
+  /** \brief Page cache size. Negative value is size in KiB. */
+  void CacheSize(int64_t size) { cache_size_ = size; }
+  [[nodiscard]] std::optional<int64_t> CacheSize() const {
+    return cache_size_;
+  }
+
+  /** \brief Memory mapped I/O size in bytes. Zero disables it. */
+  void MmapSize(int64_t size) { mmap_size_ = size; }
+  [[nodiscard]] std::optional<int64_t> MmapSize() const {
+    return mmap_size_;
+  }
+
+  void TempStore(const std::string& mode);
+  [[nodiscard]] const std::string& TempStore() const {
+    return temp_store_;
+  }
+
+  /** \brief Auto vacuum mode. Only applied on new databases and by VACUUM. */
+  void AutoVacuum(const std::string& mode);
+  [[nodiscard]] const std::string& AutoVacuum() const {
+    return auto_vacuum_;
+  }
+
+  /** \brief Returns true if no setting is changed. */
+  [[nodiscard]] bool IsDefault() const;
+
+  /** \brief Returns the settings that applies to a read-only connection.
+   *
+   * The journal, synchronous and auto vacuum modes are database settings
+   * that a read-only connection cannot change, so they are removed.
+   */
+  [[nodiscard]] SqliteProfile ReaderProfile() const;
+
+  /** \brief Returns the PRAGMA statements that applies the profile. */
+  [[nodiscard]] std::vector<std::string> MakePragmaList() const;
+
+ private:
+  std::string name_ = "default";
+  std::string journal_mode_; ///< DELETE, TRUNCATE, PERSIST, MEMORY, WAL or OFF.
+  std::string synchronous_; ///< OFF, NORMAL, FULL or EXTRA.
+  std::optional<int64_t> cache_size_;
+  std::optional<int64_t> mmap_size_;
+  std::string temp_store_; ///< DEFAULT, FILE or MEMORY.
+  std::string auto_vacuum_; ///< NONE, FULL or INCREMENTAL.
+};
+
+} // end namespace ods::detail
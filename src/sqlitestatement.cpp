@@ -2,6 +2,7 @@
  * Copyright 2021 Ingemar Hedvall
  * SPDX-License-Identifier: MIT
  */
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <sqlite3.h>
@@ -68,6 +69,13 @@ void SqliteStatement::Reset() {
   }
 }
 
+void SqliteStatement::ClearBindings() {
+  if (statement_ == nullptr) {
+    throw std::runtime_error("Statement is null");
+  }
+  sqlite3_clear_bindings(statement_);
+}
+
 void SqliteStatement::SetValue(int index, bool value) const {
   const int64_t temp = value ? 1 : 0;
   SetValue(index, temp);
@@ -140,6 +148,50 @@ void SqliteStatement::SetValue(int index, const std::vector<uint8_t> &value) con
   }
 }
 
+void SqliteStatement::AppendValue(int column, ColumnData &data) const {
+  if (statement_ == nullptr) {
+    throw std::runtime_error("Statement is null");
+  }
+  const auto type = column < 0 ? SQLITE_NULL
+                               : sqlite3_column_type(statement_, column);
+  if (type == SQLITE_NULL) {
+    data.AppendNull();
+    return;
+  }
+
+  switch (data.Storage()) {
+    case ColumnStorage::Integer:
+      data.AppendInteger(Value<int64_t>(column));
+      break;
+
+    case ColumnStorage::Float:
+      data.AppendFloat(Value<double>(column));
+      break;
+
+    case ColumnStorage::Bytes:
+      if (type == SQLITE_BLOB || type == SQLITE_TEXT) {
+        const auto* blob = sqlite3_column_blob(statement_, column);
+        const auto bytes = sqlite3_column_bytes(statement_, column);
+        data.AppendBytes(blob, bytes > 0 ? bytes : 0);
+      } else {
+        data.AppendBytes(nullptr, 0);
+      }
+      break;
+
+    default:
+      if (type == SQLITE_BLOB) {
+        // Same as the string value, a Base64 string.
+        const auto text = Value<std::string>(column);
+        data.AppendBytes(text.data(), text.size());
+      } else {
+        const auto* text = sqlite3_column_text(statement_, column);
+        const auto bytes = sqlite3_column_bytes(statement_, column);
+        data.AppendBytes(text, bytes > 0 ? bytes : 0);
+      }
+      break;
+  }
+}
+
 bool SqliteStatement::IsNull(int column) const {
   if (statement_ == nullptr) {
     throw std::runtime_error("Statement is null");
@@ -162,6 +214,16 @@ int SqliteStatement::GetColumnIndex(const std::string &column_name) const {
   return -1;
 }
 
+int SqliteStatement::ColumnCount() const {
+  return statement_ != nullptr ? sqlite3_column_count(statement_) : 0;
+}
+
+std::string SqliteStatement::ColumnName(int column) const {
+  const auto* name = statement_ != nullptr ?
+      sqlite3_column_name(statement_, column) : nullptr;
+  return name != nullptr ? name : std::string();
+}
+
 
 
 template<>
@@ -197,36 +259,26 @@ void SqliteStatement::GetValue(int column, std::string& value) const {
     }
 
     case SQLITE_TEXT: {
-      const unsigned char* temp = sqlite3_column_text(statement_, column);
+      const auto* temp = reinterpret_cast<const char*>(
+          sqlite3_column_text(statement_, column));
       const int bytes = sqlite3_column_bytes(statement_,column);
       if (bytes <= 0 || temp == nullptr) {
         value.clear();
         break;
       }
-      value.resize(bytes,'\0');
-      std::ostringstream val;
-      for (int byte = 0; byte < value.size(); ++byte) {
-
-        const char in_char =  static_cast<char>(temp[byte]);
-        if (in_char == '\0') {
-          break;
-        }
-        value[byte] = in_char;
-     }
-     break;
+      value.assign(temp, bytes);
+      break;
     }
 
     case SQLITE_BLOB: {
-      const void* temp = sqlite3_column_blob(statement_, column);
+      const auto* temp = static_cast<const uint8_t*>(
+          sqlite3_column_blob(statement_, column));
       const int bytes = sqlite3_column_bytes(statement_,column);
       if (bytes <= 0 || temp == nullptr) {
         value.clear();
         break;
       }
-      std::vector<uint8_t> byte_array(bytes, 0);
-      for (size_t byte = 0; byte < byte_array.size(); ++byte) {
-        byte_array[byte] = *(static_cast<const uint8_t*>(temp) + byte);
-      }
+      const std::vector<uint8_t> byte_array(temp, temp + bytes);
       value = OdsHelper::ToBase64(byte_array);
       break;
     }
@@ -255,9 +307,9 @@ void SqliteStatement::GetValue(int column, std::vector<uint8_t>& value) const {
     case SQLITE_TEXT: {
       const auto* temp = sqlite3_column_text(statement_, column);
       const auto bytes = sqlite3_column_bytes(statement_,column);
-      if (bytes > 0 ) {
-        value.resize(bytes, 0);
-        memcpy(value.data(), temp, bytes);
+      if (bytes > 0 && temp != nullptr) {
+        value.resize(bytes);
+        std::memcpy(value.data(), temp, bytes);
       } else {
         value.clear();
       }
@@ -267,9 +319,9 @@ void SqliteStatement::GetValue(int column, std::vector<uint8_t>& value) const {
     case SQLITE_BLOB: {
       const auto* temp = sqlite3_column_blob(statement_, column);
       const auto bytes = sqlite3_column_bytes(statement_,column);
-      if (bytes > 0 ) {
-        value.resize(bytes, 0);
-        memcpy(value.data(), temp, bytes);
+      if (bytes > 0 && temp != nullptr) {
+        value.resize(bytes);
+        std::memcpy(value.data(), temp, bytes);
       } else {
         value.clear();
       }
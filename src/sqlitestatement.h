@@ -3,9 +3,13 @@
  * SPDX-License-Identifier: MIT
  */
 #pragma once
+#include <charconv>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <sstream>
+#include <type_traits>
+#include "ods/columndata.h"
 #include "ods/icolumn.h"
 #include "sqlitedatabase.h"
 #include "odshelper.h"
@@ -20,6 +24,10 @@ class SqliteStatement final {
 
   bool Step();
   void Reset();
+  void ClearBindings();
+
+  [[nodiscard]] sqlite3* Database() const { return database_; }
+  [[nodiscard]] const std::string& Sql() const { return sql_; }
 
   [[nodiscard]] bool IsNull(int column) const;
 
@@ -39,13 +47,45 @@ class SqliteStatement final {
   template<typename T>
   T Value(const IColumn* column) const;
 
+  /** \brief Appends a column value to a column data object.
+   *
+   * Text and BLOB values are copied directly from the result row without
+   * any temporary string.
+   */
+  void AppendValue(int column, ColumnData& data) const;
+
   [[nodiscard]] int GetColumnIndex(const std::string& column_name) const;
+  [[nodiscard]] int ColumnCount() const;
+  [[nodiscard]] std::string ColumnName(int column) const;
  private:
   sqlite3*  database_ = nullptr;
   sqlite3_stmt* statement_ = nullptr;
   std::string sql_;
+
+  template<typename T>
+  static void ParseText(std::string_view text, T& value);
 };
 
+template<typename T>
+void SqliteStatement::ParseText(std::string_view text, T& value) {
+  value = {};
+  if constexpr (std::is_arithmetic_v<T>) {
+    // Same rules as the stream operator, leading spaces and '+' are allowed.
+    const auto first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+      return;
+    }
+    text.remove_prefix(first);
+    if (text.front() == '+') {
+      text.remove_prefix(1);
+    }
+    std::from_chars(text.data(), text.data() + text.size(), value);
+  } else {
+    std::istringstream val{std::string(text)};
+    val >> value;
+  }
+}
+
 template<typename T>
 void SqliteStatement::GetValue(int column, T& value) const {
   if (statement_ == nullptr) {
@@ -72,33 +112,27 @@ void SqliteStatement::GetValue(int column, T& value) const {
     }
 
     case SQLITE_TEXT: {
-      const unsigned char* temp = sqlite3_column_text(statement_, column);
+      const auto* temp = reinterpret_cast<const char*>(
+          sqlite3_column_text(statement_, column));
       const int bytes = sqlite3_column_bytes(statement_,column);
       if (bytes <= 0 || temp == nullptr) {
         value = {};
         break;
       }
-      std::stringstream val;
-      for (int byte = 0; byte < bytes; ++byte) {
-        val << static_cast<char>(temp[byte]);
-      }
-      val >> value;
+      ParseText(std::string_view(temp, bytes), value);
       break;
     }
 
     case SQLITE_BLOB: {
-      const void* blob_data = sqlite3_column_blob(statement_, column);
+      const auto* blob_data = static_cast<const uint8_t*>(
+          sqlite3_column_blob(statement_, column));
       const int nof_bytes = sqlite3_column_bytes(statement_,column);
       if (nof_bytes <= 0 || blob_data == nullptr) {
         value = {};
         break;
       }
-      std::vector<uint8_t> byte_array(nof_bytes, 0);
-      for (int index = 0; index < byte_array.size(); ++index) {
-        byte_array[index] = *(static_cast<const uint8_t*>(blob_data) + index);
-      }
-      std::istringstream val(OdsHelper::ToBase64(byte_array));
-      val >> value;
+      const std::vector<uint8_t> byte_array(blob_data, blob_data + nof_bytes);
+      ParseText(OdsHelper::ToBase64(byte_array), value);
       break;
     }
 
@@ -0,0 +1,76 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#include "sqlitestatementcache.h"
+#include <util/logstream.h>
+#include "sqlitestatement.h"
+
+using namespace util::log;
+
+namespace ods::detail {
+
+SqliteStatementCache::SqliteStatementCache(size_t max_statements)
+: max_statements_(max_statements) {
+}
+
+SqliteStatementCache::~SqliteStatementCache() {
+  Clear();
+}
+
+std::unique_ptr<SqliteStatement> SqliteStatementCache::Acquire(
+    sqlite3 *database, const std::string &sql) {
+  if (auto itr = cache_list_.find(sql); itr != cache_list_.end()) {
+    auto statement = std::move(*itr->second);
+    lru_list_.erase(itr->second);
+    cache_list_.erase(itr);
+    if (statement && statement->Database() == database) {
+      return statement;
+    }
+  }
+  return std::make_unique<SqliteStatement>(database, sql);
+}
+
+void SqliteStatementCache::Release(std::unique_ptr<SqliteStatement> statement) {
+  if (!statement || max_statements_ == 0) {
+    return;
+  }
+  try {
+    statement->Reset();
+    statement->ClearBindings();
+  } catch (const std::exception& err) {
+    // The statement failed in the last step. Do not keep it.
+    LOG_DEBUG() << "Dropped a cached statement. Error: " << err.what();
+    return;
+  }
+
+  const std::string sql = statement->Sql();
+  if (auto itr = cache_list_.find(sql); itr != cache_list_.end()) {
+    // Another statement with the same SQL was released. Keep the newest.
+    lru_list_.erase(itr->second);
+    cache_list_.erase(itr);
+  }
+  while (!lru_list_.empty() && lru_list_.size() >= max_statements_) {
+    RemoveLeastUsed();
+  }
+  lru_list_.push_front(std::move(statement));
+  cache_list_.emplace(sql, lru_list_.begin());
+}
+
+void SqliteStatementCache::Clear() {
+  cache_list_.clear();
+  lru_list_.clear();
+}
+
+void SqliteStatementCache::RemoveLeastUsed() {
+  if (lru_list_.empty()) {
+    return;
+  }
+  const auto& statement = lru_list_.back();
+  if (statement) {
+    cache_list_.erase(statement->Sql());
+  }
+  lru_list_.pop_back();
+}
+
+} // end namespace ods::detail
@@ -0,0 +1,83 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+#pragma once
+#include <cstdint>
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include "sqlite3.h"
+
+namespace ods::detail {
+
+class SqliteStatement;
+
+/** \brief Cache of prepared statements for one SQLite connection.
+ *
+ * Preparing a statement means that SQLite parses and plans the SQL text,
+ * which is costly if it is done for each inserted row. The cache keeps the
+ * prepared statements alive between the calls, so the caller only needs to
+ * bind new values.
+ *
+ * A statement is checked out with Acquire() and given back with Release().
+ * The Release() function resets the statement and clears its bindings. A
+ * checked out statement is not in the cache, so a recursive call with the
+ * same SQL prepares a new statement instead of using a busy statement.
+ *
+ * The SQL text is the key, so the values shall be bound parameters and not
+ * part of the SQL text, e.g. an INSERT, or a SELECT or an UPDATE with its
+ * WHERE values as parameters.
+ *
+ * The cache belongs to an open connection and must be cleared before the
+ * connection is closed.
+ */
+class SqliteStatementCache final {
+ public:
+  explicit SqliteStatementCache(size_t max_statements = 64);
+  ~SqliteStatementCache();
+
+  SqliteStatementCache(const SqliteStatementCache&) = delete;
+  SqliteStatementCache& operator = (const SqliteStatementCache&) = delete;
+
+  /** \brief Returns a prepared statement.
+   *
+   * Returns a cached statement if it exists, otherwise the SQL text is
+   * prepared.
+   * @param database Open SQLite connection.
+   * @param sql SQL text. It is also the key in the cache.
+   * @return A prepared statement, ready to be bound.
+   */
+  [[nodiscard]] std::unique_ptr<SqliteStatement> Acquire(sqlite3* database,
+      const std::string& sql);
+
+  /** \brief Gives back a statement to the cache. */
+  void Release(std::unique_ptr<SqliteStatement> statement);
+
+  /** \brief Finalizes all cached statements. */
+  void Clear();
+
+  [[nodiscard]] size_t Size() const {
+    return lru_list_.size();
+  }
+
+  void MaxStatements(size_t max_statements) {
+    max_statements_ = max_statements;
+  }
+  [[nodiscard]] size_t MaxStatements() const {
+    return max_statements_;
+  }
+
+ private:
+  using StatementList = std::list<std::unique_ptr<SqliteStatement>>;
+  /** \brief Statements with the most recently used first. */
+  StatementList lru_list_;
+  /** \brief SQL text to its statement in the LRU list. */
+  std::map<std::string, StatementList::iterator> cache_list_;
+  size_t max_statements_ = 64;
+
+  void RemoveLeastUsed();
+};
+
+} // end namespace ods::detail
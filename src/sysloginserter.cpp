@@ -96,6 +96,8 @@ void SyslogInserter::Init() {
   try {
     if (database_) {
       database_->ConnectionInfo(connection_string_);
+      // Keep the connection open between the ticks.
+      database_->Persistent(true);
       DatabaseGuard db_lock(*database_);
       const auto read = database_->ReadModel(model_);
       IsOk(read);
@@ -149,9 +151,7 @@ void SyslogInserter::Tick() {
     return;
   }
   try {
-    for ( auto& msg : *syslog_list) {
-      InsertMessage(msg);
-    }
+    InsertMessages(*syslog_list);
     IsOk(true);
   } catch( const std::exception& err) {
     db_lock.Rollback();
@@ -166,6 +166,9 @@ void SyslogInserter::Tick() {
 
 void SyslogInserter::Exit() {
   ITask::Exit();
+  if (database_) {
+    database_->Close(true);
+  }
   database_.reset();
 }
 
@@ -175,38 +178,78 @@ void SyslogInserter::InsertMessage(SyslogMessage &msg) {
   if (table == nullptr ) {
     return;
   }
-  const auto& hostname = msg.Hostname();
-  const auto& app_name = msg.ApplicationName();
-
-  IItem row(table->ApplicationId());
-  row.AppendAttribute(*table, true, "name", msg.Message());
-  row.AppendAttribute(*table, true, "date", msg.Timestamp());
-  row.AppendAttribute(*table, false, "Severity",
-                      static_cast<int>(msg.Severity()));
-  row.AppendAttribute(*table, false, "Facility",
-                      static_cast<int>(msg.Facility()));
-
-  row.AppendAttribute(*table, false, "Hostname",
-                      InsertHost(hostname));
-  row.AppendAttribute(*table, false, "Application",
-                      InsertApplication(app_name));
-  row.AppendAttribute(*table, false, "ProcessID",
-                      msg.ProcessId());
-  row.AppendAttribute(*table, false, "MessageID",
-                      msg.MessageId());
 
+  IItem row = MakeMessageRow(*table, msg);
   database_->Insert(*table, row, SqlFilter());
 
+  std::vector<IItem> value_list;
   const auto& sd_list = msg.DataList();
   for (const auto& data : sd_list) {
-    InsertData(data, row.ItemId());
+    InsertData(data, row.ItemId(), value_list);
   }
+  InsertValues(value_list);
   msg.Index(row.ItemId());
 
   std::lock_guard lock(last_message_locker_);
   last_message_ = msg;
 }
 
+void SyslogInserter::InsertMessages(SyslogList &msg_list) {
+  auto* table = model_.GetTableByName("Syslog");
+  if (table == nullptr || msg_list.empty()) {
+    return;
+  }
+
+  // First insert all messages as one batch, so the message indexes are known
+  // before the structured data is inserted.
+  std::vector<IItem> row_list;
+  row_list.reserve(msg_list.size());
+  for (const auto& msg : msg_list) {
+    row_list.push_back(MakeMessageRow(*table, msg));
+  }
+  database_->InsertBatch(*table, row_list);
+
+  std::vector<IItem> value_list;
+  auto row_itr = row_list.cbegin();
+  for (auto& msg : msg_list) {
+    const int64_t msg_idx = row_itr->ItemId();
+    ++row_itr;
+    const auto& sd_list = msg.DataList();
+    for (const auto& data : sd_list) {
+      InsertData(data, msg_idx, value_list);
+    }
+    msg.Index(msg_idx);
+  }
+  InsertValues(value_list);
+
+  std::lock_guard lock(last_message_locker_);
+  last_message_ = msg_list.back();
+}
+
+IItem SyslogInserter::MakeMessageRow(const ITable& table,
+                                     const SyslogMessage &msg) {
+  const auto& hostname = msg.Hostname();
+  const auto& app_name = msg.ApplicationName();
+
+  IItem row(table.ApplicationId());
+  row.AppendAttribute(table, true, "name", msg.Message());
+  row.AppendAttribute(table, true, "date", msg.Timestamp());
+  row.AppendAttribute(table, false, "Severity",
+                      static_cast<int>(msg.Severity()));
+  row.AppendAttribute(table, false, "Facility",
+                      static_cast<int>(msg.Facility()));
+
+  row.AppendAttribute(table, false, "Hostname",
+                      InsertHost(hostname));
+  row.AppendAttribute(table, false, "Application",
+                      InsertApplication(app_name));
+  row.AppendAttribute(table, false, "ProcessID",
+                      msg.ProcessId());
+  row.AppendAttribute(table, false, "MessageID",
+                      msg.MessageId());
+  return row;
+}
+
 int64_t SyslogInserter::InsertHost(const std::string &hostname) {
   if (hostname.empty()) {
     return 0;
@@ -274,7 +317,8 @@ int64_t SyslogInserter::InsertApplication(const std::string &app_name) {
   return idx;
 }
 
-void SyslogInserter::InsertData(const StructuredData &data, int64_t msg_idx) {
+void SyslogInserter::InsertData(const StructuredData &data, int64_t msg_idx,
+                                std::vector<IItem>& value_list) {
   const auto identity_idx = InsertIdentity(data);
   if (identity_idx == 0) {
     return;
@@ -322,14 +366,21 @@ void SyslogInserter::InsertData(const StructuredData &data, int64_t msg_idx) {
       continue;
     }
 
-    IItem value_row(value_table->ApplicationId());
+    IItem& value_row = value_list.emplace_back(value_table->ApplicationId());
     value_row.AppendAttribute(*value_table, true, "name",value);
     value_row.AppendAttribute(*value_table, true, "parent", msg_idx);
     value_row.AppendAttribute(*value_table, false, "SdName", key_idx);
-    database_->Insert(*key_table, value_row, SqlFilter());
   }
 }
 
+void SyslogInserter::InsertValues(std::vector<IItem>& value_list) {
+  auto* value_table = model_.GetTableByName("SdData");
+  if (value_table == nullptr || value_list.empty()) {
+    return;
+  }
+  database_->InsertBatch(*value_table, value_list);
+}
+
 int64_t SyslogInserter::InsertIdentity(const StructuredData &data){
   const auto& identity = data.Identity();
    if (identity.empty()) {
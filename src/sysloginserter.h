@@ -8,6 +8,7 @@
 #include <workflow/itask.h>
 #include <map>
 #include <mutex>
+#include <vector>
 #include "ods/imodel.h"
 #include "ods/idatabase.h"
 #include <util/syslogmessage.h>
@@ -57,9 +58,14 @@ private:
 
   void ParseArguments();
   void InsertMessage( util::syslog::SyslogMessage& msg);
+  void InsertMessages(std::vector<util::syslog::SyslogMessage>& msg_list);
+  [[nodiscard]] IItem MakeMessageRow(const ITable& table,
+                                     const util::syslog::SyslogMessage& msg);
   int64_t InsertHost(const std::string& hostname);
   int64_t InsertApplication(const std::string& app_name);
-  void InsertData(const util::syslog::StructuredData& data, int64_t msg_idx);
+  void InsertData(const util::syslog::StructuredData& data, int64_t msg_idx,
+                  std::vector<IItem>& value_list);
+  void InsertValues(std::vector<IItem>& value_list);
   int64_t InsertIdentity(const util::syslog::StructuredData& data);
 };
 
@@ -0,0 +1,194 @@
+/*
+ * Copyright 2024 Ingemar Hedvall
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <iterator>
+#include <stdexcept>
+
+#include "util/stringutil.h"
+#include "ods/tablelayout.h"
+
+using namespace util::string;
+
+namespace {
+
+// Name types in the ITable column index.
+constexpr size_t kApplicationName = 0;
+constexpr size_t kBaseName = 2;
+
+std::string MakeKey(const std::string& name) {
+  std::string key = name;
+  std::ranges::transform(key, key.begin(), [] (unsigned char input) {
+    return static_cast<char>(std::tolower(input));
+  });
+  return key;
+}
+
+const std::string& ColumnName(const ods::IColumn& column, size_t name_type) {
+  return name_type == kBaseName ? column.BaseName() : column.ApplicationName();
+}
+
+} // end namespace
+
+namespace ods {
+
+TableLayout::TableLayout(const ITable &table)
+: table_(table),
+  index_(table.GetColumnIndex()) {
+}
+
+const IColumn &TableLayout::Column(size_t ordinal) const {
+  const auto& column_list = table_.Columns();
+  if (ordinal >= column_list.size()) {
+    throw std::out_of_range("Column ordinal is out of range.");
+  }
+  return column_list[ordinal];
+}
+
+int TableLayout::Ordinal(const std::string &name) const {
+  return FindOrdinal(kApplicationName, name);
+}
+
+int TableLayout::BaseOrdinal(const std::string &base_name) const {
+  return FindOrdinal(kBaseName, base_name);
+}
+
+int TableLayout::FindOrdinal(size_t name_type, const std::string &name) const {
+  if (name.empty() || !index_) {
+    return -1;
+  }
+  const auto& map = index_->map_list[name_type];
+  const auto itr = map.find(MakeKey(name));
+  if (itr == map.cend()) {
+    return -1;
+  }
+  const auto& column_list = table_.Columns();
+  if (itr->second < column_list.size() &&
+      IEquals(name, ColumnName(column_list[itr->second], name_type))) {
+    return static_cast<int>(itr->second);
+  }
+
+  // The column names have been changed after the index was built.
+  const auto find = std::ranges::find_if(column_list,
+                                         [&] (const auto& column) {
+    return IEquals(name, ColumnName(column, name_type));
+  });
+  return find == column_list.cend() ? -1 :
+      static_cast<int>(std::distance(column_list.cbegin(), find));
+}
+
+TableLayout::AttributeRefList TableLayout::MapItem(const IItem &item) const {
+  AttributeRefList attr_list(NofColumns(), nullptr);
+  for (const auto& attribute : item.AttributeList()) {
+    const auto ordinal = Ordinal(attribute.Name());
+    if (ordinal >= 0 && attr_list[ordinal] == nullptr) {
+      attr_list[ordinal] = &attribute;
+    }
+  }
+  return attr_list;
+}
+
+TableRow::TableRow(const TableLayout &layout)
+: layout_(&layout),
+  set_list_(layout.NofColumns(), false) {
+  attribute_list_.reserve(layout.NofColumns());
+  for (const auto& column : layout.Table().Columns()) {
+    attribute_list_.emplace_back(column.ApplicationName(), column.BaseName(),
+                                 "");
+  }
+}
+
+TableRow::TableRow(const TableLayout &layout, const IItem &item)
+: TableRow(layout) {
+  Assign(item);
+}
+
+int64_t TableRow::ItemId() const {
+  if (item_id_ <= 0) {
+    // Fetch it from the base name 'id' column.
+    const auto* id_attr = GetBaseAttribute("id");
+    if (id_attr != nullptr) {
+      return id_attr->Value<int64_t>();
+    }
+  }
+  return item_id_;
+}
+
+void TableRow::ItemId(int64_t index) {
+  item_id_ = index;
+  const auto ordinal = layout_->BaseOrdinal("id");
+  if (ordinal >= 0 && IsSet(ordinal)) {
+    attribute_list_[ordinal].Value(index);
+  }
+}
+
+bool TableRow::IsSet(size_t ordinal) const {
+  return ordinal < set_list_.size() && set_list_[ordinal];
+}
+
+const IAttribute *TableRow::Attribute(size_t ordinal) const {
+  return IsSet(ordinal) ? &attribute_list_[ordinal] : nullptr;
+}
+
+const IAttribute *TableRow::GetAttribute(const std::string &name) const {
+  const auto ordinal = layout_->Ordinal(name);
+  return ordinal < 0 ? nullptr : Attribute(ordinal);
+}
+
+const IAttribute *TableRow::GetBaseAttribute(
+    const std::string &base_name) const {
+  const auto ordinal = layout_->BaseOrdinal(base_name);
+  return ordinal < 0 ? nullptr : Attribute(ordinal);
+}
+
+void TableRow::Reset(size_t ordinal) {
+  if (ordinal < attribute_list_.size()) {
+    attribute_list_[ordinal].Value(std::string());
+    set_list_[ordinal] = false;
+  }
+}
+
+void TableRow::Clear() {
+  for (size_t ordinal = 0; ordinal < attribute_list_.size(); ++ordinal) {
+    Reset(ordinal);
+  }
+  item_id_ = 0;
+}
+
+void TableRow::Assign(const IItem &item) {
+  Clear();
+  const auto attr_list = layout_->MapItem(item);
+  for (size_t ordinal = 0; ordinal < attr_list.size(); ++ordinal) {
+    const auto* attr = attr_list[ordinal];
+    if (attr == nullptr) {
+      continue;
+    }
+    // Copy the typed value but keep the column names.
+    const auto& column = layout_->Column(ordinal);
+    auto& attribute = attribute_list_[ordinal];
+    attribute = *attr;
+    attribute.Name(column.ApplicationName());
+    attribute.BaseName(column.BaseName());
+    set_list_[ordinal] = true;
+  }
+  item_id_ = item.ItemId();
+}
+
+IItem TableRow::ToItem() const {
+  IItem item(layout_->Table().ApplicationId());
+  item.AttributeList().reserve(attribute_list_.size());
+  for (size_t ordinal = 0; ordinal < attribute_list_.size(); ++ordinal) {
+    if (set_list_[ordinal]) {
+      item.AppendAttribute(attribute_list_[ordinal]);
+    }
+  }
+  if (item_id_ > 0) {
+    item.ItemId(item_id_);
+  }
+  return item;
+}
+
+}  // namespace ods
@@ -85,7 +85,12 @@ namespace ods::detail {
 
 TestDirectory::TestDirectory()
 : IEnvironment(EnvironmentType::kTypeTestDirectory) {
-  database_ = std::make_unique<SqliteDatabase>();
+  auto database = std::make_unique<SqliteDatabase>();
+  // WAL mode so the readers doesn't block the directory scanner.
+  database->Profile(SqliteProfile::Preset("wal"));
+  // Keep the connection open between the scans.
+  database->Persistent(true);
+  database_ = std::move(database);
 }
 
 TestDirectory::~TestDirectory() {
@@ -311,6 +316,9 @@ void TestDirectory::Stop() {
   if (worker_thread_.joinable()) {
     worker_thread_.join();
   }
+  if (database_) {
+    database_->Close(true);
+  }
   LOG_DEBUG() << "Worker thread stopped. Environment: " << Name();
 }
 
@@ -983,6 +991,9 @@ bool TestDirectory::UpdateMq(const IDataGroup &data_group, int64_t parent_index)
     return false;
   }
 
+  // New MQ are inserted in one batch after the scan.
+  std::vector<IItem> insert_list;
+
   // Scan through all DG blocks
   const auto cg_list = data_group.ChannelGroups();
   for (const auto* channel_group : cg_list) {
@@ -996,7 +1007,6 @@ bool TestDirectory::UpdateMq(const IDataGroup &data_group, int64_t parent_index)
       if (channel == nullptr || channel->Name().empty()) {
         continue;
       }
-      int64_t mq_index = 0;
       const std::string name = channel->Name();
       // Insert or update
 
@@ -1009,7 +1019,7 @@ bool TestDirectory::UpdateMq(const IDataGroup &data_group, int64_t parent_index)
         // MQ only needs to be updated if nof samples are bigger
         const std::unique_ptr<IItem>& mq_item = *exist;
 
-        mq_index = mq_item->ItemId();
+        const int64_t mq_index = mq_item->ItemId();
         const auto samples = mq_item->Value<uint64_t>("Samples");
 
         if (nof_samples > samples) {
@@ -1026,33 +1036,43 @@ bool TestDirectory::UpdateMq(const IDataGroup &data_group, int64_t parent_index)
             return false;
           }
         }
+        continue;
+      }
+
+      // The MQ may exist in multiple channel groups.
+      const auto new_mq = std::ranges::find_if(insert_list, [&] (const IItem& item) {
+        return IEquals(name, item.Name());
+      });
+      if (new_mq != insert_list.end()) {
+        auto* samples = new_mq->GetAttribute("Samples");
+        if (samples != nullptr && nof_samples > samples->Value<uint64_t>()) {
+          samples->Value(nof_samples);
+        }
       } else {
         // Insert MQ
         int64_t quantity_index = UpdateQuantity(*channel);
         int64_t unit_index = UpdateUnit(channel->Unit());
         const auto independent = channel->Type() == ChannelType::Master || channel->Type() == ChannelType::VirtualMaster;
-        auto item = std::make_unique<IItem>();
-        item->ApplicationId(table->ApplicationId());
-        item->AppendAttribute(*table, true,"name", name);
-        item->AppendAttribute(*table, true,"measurement", parent_index);
-        item->AppendAttribute(*table, true,"datatype", static_cast<long>(ChannelTypeToDataType(*channel)));
-        item->AppendAttribute(*table, true,"quantity", quantity_index);
-        item->AppendAttribute(*table, true,"unit", unit_index);
-        item->AppendAttribute(*table, false,"Samples", nof_samples);
-        item->AppendAttribute(*table, false,"Independent", independent);
-        try {
-          database_->Insert(*table,*item, SqlFilter());
-          mq_index = item->ItemId();
-        } catch (const std::exception& err) {
-          LOG_ERROR() << "Failed to insert measurement quantity. Name: " << name
-                      << ", Error: " << err.what();
-          return false;
-        }
-        db_list.push_back(std::move(item)); // In case MQ is in multiple channel groups
+        IItem& item = insert_list.emplace_back();
+        item.ApplicationId(table->ApplicationId());
+        item.AppendAttribute(*table, true,"name", name);
+        item.AppendAttribute(*table, true,"measurement", parent_index);
+        item.AppendAttribute(*table, true,"datatype", static_cast<long>(ChannelTypeToDataType(*channel)));
+        item.AppendAttribute(*table, true,"quantity", quantity_index);
+        item.AppendAttribute(*table, true,"unit", unit_index);
+        item.AppendAttribute(*table, false,"Samples", nof_samples);
+        item.AppendAttribute(*table, false,"Independent", independent);
       }
     }
   }
 
+  try {
+    database_->InsertBatch(*table, insert_list);
+  } catch (const std::exception& err) {
+    LOG_ERROR() << "Failed to insert measurement quantities. Name: " << data_group.Description()
+                << ", Error: " << err.what();
+    return false;
+  }
   return true;
 }
 
@@ -109,4 +109,41 @@ TEST(IAttribute, TestArray) {
     EXPECT_EQ(byte_array[index], dest_array[index]) << index;
   }
 }
+
+TEST(IAttribute, TestTypedValue) {
+  IAttribute attr;
+
+  // Typed values keep the same string representation as before.
+  attr.Value(int64_t{-123});
+  EXPECT_EQ(attr.Value<std::string>(), "-123");
+  EXPECT_EQ(attr.Value<int32_t>(), -123);
+  EXPECT_DOUBLE_EQ(attr.Value<double>(), -123.0);
+
+  constexpr uint64_t kNs = 1'700'000'000'123'456'789;
+  attr.Value(kNs);
+  EXPECT_TRUE(attr.IsValueUnsigned());
+  EXPECT_EQ(attr.Value<uint64_t>(), kNs);
+  EXPECT_EQ(attr.Value<std::string>(), "1700000000123456789");
+
+  attr.Value(1.5);
+  EXPECT_EQ(attr.Value<std::string>(), "1.5");
+  EXPECT_EQ(attr.Value<int64_t>(), 1);
+
+  attr.Value(1.23F);
+  EXPECT_EQ(attr.Value<std::string>(), "1.23");
+  EXPECT_DOUBLE_EQ(attr.Value<double>(), 1.23);
+
+  attr.Value(false);
+  EXPECT_EQ(attr.Value<std::string>(), "0");
+  EXPECT_FALSE(attr.Value<bool>());
+  EXPECT_EQ(attr.Value<int64_t>(), 0);
+
+  // Strings are still parsed on request.
+  attr.Value(std::string("4711"));
+  EXPECT_EQ(attr.Value<int64_t>(), 4711);
+  EXPECT_TRUE(attr.IsValueUnsigned());
+
+  attr.Value(std::vector<uint8_t>());
+  EXPECT_TRUE(attr.IsValueEmpty());
+}
 } // End namespace ods::test
\ No newline at end of file
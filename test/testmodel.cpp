@@ -163,4 +163,83 @@ TEST_F(TestModel, ModelSave) {
   }
 }
 
+TEST_F(TestModel, ModelTableIndex) {
+  IModel model;
+
+  ITable test_table;
+  test_table.ApplicationId(10);
+  test_table.BaseId(BaseId::AoTest);
+  test_table.ApplicationName("Test");
+  test_table.DatabaseName("test_db");
+  model.AddTable(test_table);
+
+  ITable meas_table;
+  meas_table.ApplicationId(11);
+  meas_table.ParentId(10);
+  meas_table.BaseId(BaseId::AoMeasurement);
+  meas_table.ApplicationName("Meas");
+  meas_table.DatabaseName("meas_db");
+  model.AddTable(meas_table);
+
+  const auto* test = model.GetTableByName("TEST");
+  ASSERT_TRUE(test != nullptr);
+  EXPECT_EQ(test->ApplicationId(), 10);
+  EXPECT_EQ(model.GetTable(10), test);
+  EXPECT_EQ(model.GetTableByDbName("Test_Db"), test);
+  EXPECT_EQ(model.GetTableByName("test_db"), test);
+  EXPECT_EQ(model.GetTableByBaseId(BaseId::AoTest), test);
+
+  const auto* meas = model.GetTableByName("meas");
+  ASSERT_TRUE(meas != nullptr);
+  EXPECT_EQ(meas->ParentId(), 10);
+  EXPECT_EQ(model.GetTable(11), meas);
+  EXPECT_EQ(model.GetTableByBaseId(BaseId::AoMeasurement), meas);
+  EXPECT_EQ(model.GetTableByName("Unknown"), nullptr);
+
+  // Tables added after the index is built.
+  ITable unit_table;
+  unit_table.ApplicationId(20);
+  unit_table.BaseId(BaseId::AoUnit);
+  unit_table.ApplicationName("Unit");
+  unit_table.DatabaseName("unit_db");
+  model.AddTable(unit_table);
+  const auto* unit = model.GetTableByBaseId(BaseId::AoUnit);
+  ASSERT_TRUE(unit != nullptr);
+  EXPECT_EQ(model.GetTableByName("Unit"), unit);
+  EXPECT_EQ(model.GetTable(20), unit);
+
+  ITable sub_test;
+  sub_test.ApplicationId(30);
+  sub_test.ParentId(11);
+  sub_test.BaseId(BaseId::AoTest);
+  sub_test.ApplicationName("SubTest");
+  model.AddTable(sub_test);
+  EXPECT_EQ(model.GetTableByBaseId(BaseId::AoTest), test);
+  EXPECT_EQ(model.GetTableByName("SubTest")->ParentId(), 11);
+
+  ITable renamed = *test;
+  renamed.ApplicationName("Renamed");
+  renamed.DatabaseName("renamed_db");
+  EXPECT_TRUE(model.UpdateTable(renamed));
+  EXPECT_EQ(model.GetTableByName("Renamed"), test);
+  EXPECT_EQ(model.GetTableByDbName("renamed_db"), test);
+  EXPECT_EQ(model.GetTableByName("Test"), nullptr);
+  EXPECT_EQ(model.GetTableByBaseId(BaseId::AoTest), test);
+  renamed.ApplicationId(99);
+  EXPECT_FALSE(model.UpdateTable(renamed));
+
+  EXPECT_TRUE(model.DeleteTable(11));
+  EXPECT_EQ(model.GetTable(11), nullptr);
+  EXPECT_EQ(model.GetTableByName("Meas"), nullptr);
+  EXPECT_EQ(model.GetTableByName("SubTest"), nullptr);
+  EXPECT_EQ(model.GetTable(10), test);
+
+  const IModel copy = model;
+  EXPECT_EQ(copy.GetTableByName("Unit"), &copy.Tables().at(20));
+
+  model.ClearTableList();
+  EXPECT_EQ(model.GetTable(10), nullptr);
+  EXPECT_EQ(model.GetTableByBaseId(BaseId::AoUnit), nullptr);
+}
+
 } // ods
\ No newline at end of file
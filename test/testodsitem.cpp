@@ -5,6 +5,10 @@
 
 #include <gtest/gtest.h>
 #include "ods/iattribute.h"
+#include "ods/iitem.h"
+#include "ods/itable.h"
+#include "ods/tablelayout.h"
+#include "ods/columndata.h"
 
 using namespace ods;
 
@@ -33,4 +37,147 @@ TEST(OdsItem, TestNormal) { // NOLINT
   EXPECT_EQ(item5.Value<double>(), 1/3.0);
 }
 
+TEST(OdsItem, TestTableRow) { // NOLINT
+  ITable table;
+  table.ApplicationId(1);
+  table.ApplicationName("TestA");
+  table.DatabaseName("test_a");
+
+  IColumn id_column;
+  id_column.ApplicationName("Id");
+  id_column.BaseName("id");
+  id_column.DatabaseName("id");
+  id_column.DataType(DataType::DtId);
+  table.AddColumn(id_column);
+
+  IColumn int_column;
+  int_column.ApplicationName("IntValue");
+  int_column.DatabaseName("int_value");
+  int_column.DataType(DataType::DtLongLong);
+  table.AddColumn(int_column);
+
+  IColumn text_column;
+  text_column.ApplicationName("TextValue");
+  text_column.DatabaseName("text_value");
+  text_column.DataType(DataType::DtString);
+  table.AddColumn(text_column);
+
+  const TableLayout layout(table);
+  EXPECT_EQ(layout.NofColumns(), 3);
+  EXPECT_EQ(layout.Ordinal("textvalue"), 2);
+  EXPECT_EQ(layout.BaseOrdinal("ID"), 0);
+  EXPECT_EQ(layout.Ordinal("Unknown"), -1);
+
+  IItem item(table.ApplicationId());
+  item.AppendAttribute(table, false, "TextValue", "Olle");
+  item.AppendAttribute(table, false, "IntValue", 123);
+  item.AppendAttribute({"Unknown", 1});
+
+  const auto attr_list = layout.MapItem(item);
+  ASSERT_EQ(attr_list.size(), 3);
+  EXPECT_EQ(attr_list[0], nullptr);
+  ASSERT_NE(attr_list[1], nullptr);
+  EXPECT_EQ(attr_list[1]->Value<int64_t>(), 123);
+
+  TableRow row(layout, item);
+  EXPECT_FALSE(row.IsSet(0));
+  EXPECT_EQ(row.Value<int64_t>(1), 123);
+  EXPECT_EQ(row.Value<std::string>(2), "Olle");
+  EXPECT_EQ(row.GetAttribute("INTVALUE"), row.Attribute(1));
+
+  row.Value(0, int64_t{11});
+  EXPECT_EQ(row.ItemId(), 11);
+
+  const auto dest = row.ToItem();
+  EXPECT_EQ(dest.ApplicationId(), 1);
+  EXPECT_EQ(dest.AttributeList().size(), 3);
+  EXPECT_EQ(dest.ItemId(), 11);
+  EXPECT_EQ(dest.Value<int64_t>("IntValue"), 123);
+  EXPECT_EQ(dest.Value<std::string>("TextValue"), "Olle");
+
+  row.Clear();
+  EXPECT_EQ(row.Attribute(1), nullptr);
+  EXPECT_EQ(row.ToItem().AttributeList().size(), 0);
+
+  // The layout shares the table index, but doesn't trust a stale index.
+  auto& renamed = table.Columns()[2];
+  EXPECT_EQ(table.GetColumnByName("TextValue"), &renamed);
+  renamed.ApplicationName("Renamed");
+  const TableLayout layout2(table);
+  EXPECT_EQ(layout2.Ordinal("TextValue"), -1);
+  EXPECT_EQ(layout2.Ordinal("IntValue"), 1);
+}
+
+TEST(OdsItem, TestColumnLookup) { // NOLINT
+  ITable table;
+  table.ApplicationId(1);
+  table.ApplicationName("TestA");
+
+  IColumn id_column;
+  id_column.ApplicationName("Id");
+  id_column.BaseName("id");
+  id_column.DatabaseName("iid");
+  table.AddColumn(id_column);
+
+  IColumn name_column;
+  name_column.ApplicationName("Name");
+  name_column.BaseName("name");
+  name_column.DatabaseName("name_text");
+  table.AddColumn(name_column);
+
+  const auto& const_table = table;
+  const auto* id = const_table.GetColumnByName("ID");
+  ASSERT_TRUE(id != nullptr);
+  EXPECT_EQ(id->ApplicationName(), "Id");
+  EXPECT_EQ(const_table.GetColumnByName("iid"), id);
+  EXPECT_EQ(const_table.GetColumnByDbName("Name_Text"),
+            &const_table.Columns()[1]);
+  EXPECT_EQ(const_table.GetColumnByBaseName("NAME"),
+            &const_table.Columns()[1]);
+  EXPECT_EQ(const_table.GetColumnByName("Unknown"), nullptr);
+
+  IColumn value_column;
+  value_column.ApplicationName("Value");
+  table.AddColumn(value_column);
+  const auto* value = const_table.GetColumnByName("value");
+  ASSERT_TRUE(value != nullptr);
+  EXPECT_EQ(value->ApplicationName(), "Value");
+
+  table.DeleteColumn("NAME");
+  EXPECT_EQ(const_table.Columns().size(), 2);
+  EXPECT_EQ(const_table.GetColumnByName("Name"), nullptr);
+  EXPECT_EQ(const_table.GetColumnByName("Value"), &const_table.Columns()[1]);
+
+  table.Columns()[1].ApplicationName("Renamed");
+  EXPECT_EQ(const_table.GetColumnByName("Value"), nullptr);
+  EXPECT_EQ(const_table.GetColumnByName("renamed"),
+            &const_table.Columns()[1]);
+
+  const ITable copy = table;
+  EXPECT_EQ(copy.GetColumnByName("renamed"), &copy.Columns()[1]);
+  EXPECT_TRUE(copy == table);
+}
+
+TEST(OdsItem, TestBooleanColumn) { // NOLINT
+  IColumn column;
+  column.ApplicationName("Flag");
+  column.DataType(DataType::DtBoolean);
+
+  // PostgreSQL text results returns booleans as "t" and "f".
+  ColumnData data(column);
+  EXPECT_EQ(data.Storage(), ColumnStorage::Integer);
+  const IAttribute true_text("Flag", std::string("t"));
+  const IAttribute false_text("Flag", std::string("f"));
+  const IAttribute true_value("Flag", true);
+  data.AppendAttribute(&true_text);
+  data.AppendAttribute(&false_text);
+  data.AppendAttribute(&true_value);
+  data.AppendAttribute(nullptr);
+  ASSERT_EQ(data.Size(), 4);
+  EXPECT_EQ(data.Integers()[0], 1);
+  EXPECT_EQ(data.Integers()[1], 0);
+  EXPECT_EQ(data.Integers()[2], 1);
+  EXPECT_TRUE(data.IsNull(3));
+}
+
 } // end namespace
\ No newline at end of file
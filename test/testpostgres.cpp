@@ -8,6 +8,10 @@
 #include <string_view>
 #include <array>
 #include <filesystem>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <limits>
 
 #include <util/logstream.h>
 #include <util/logconfig.h>
@@ -16,7 +20,13 @@
 
 #include "postgresdb.h"
 #include "postgresstatement.h"
+#include "odshelper.h"
+#include "postgresparameters.h"
+#include "postgrescopy.h"
+#include "postgresconnectionpool.h"
 #include "ods/databaseguard.h"
+#include "ods/itable.h"
+#include "ods/iitem.h"
 
 using namespace util::log;
 using namespace util::string;
@@ -24,6 +34,7 @@ using namespace util::time;
 
 using namespace std::filesystem;
 using namespace ods::detail;
+using namespace std::chrono_literals;
 
 namespace {
 
@@ -38,6 +49,40 @@ constexpr std::string_view kSelectDb = "SELECT * FROM test_a";
 
 bool kSkipTest = false;
 
+ods::ITable MakeTestTable() {
+  using namespace ods;
+  ITable table;
+  table.ApplicationId(1);
+  table.ApplicationName("TestA");
+  table.DatabaseName("test_a");
+
+  IColumn id_column;
+  id_column.ApplicationName("Id");
+  id_column.BaseName("id");
+  id_column.DatabaseName("id");
+  id_column.DataType(DataType::DtId);
+  table.AddColumn(id_column);
+
+  IColumn int_column;
+  int_column.ApplicationName("IntValue");
+  int_column.DatabaseName("int_value");
+  int_column.DataType(DataType::DtLongLong);
+  table.AddColumn(int_column);
+
+  IColumn text_column;
+  text_column.ApplicationName("TextValue");
+  text_column.DatabaseName("text_value");
+  text_column.DataType(DataType::DtString);
+  table.AddColumn(text_column);
+
+  IColumn blob_column;
+  blob_column.ApplicationName("BlobValue");
+  blob_column.DatabaseName("blob_value");
+  blob_column.DataType(DataType::DtBlob);
+  table.AddColumn(blob_column);
+  return table;
+}
+
 }
 
 namespace ods::test {
@@ -345,4 +390,649 @@ TEST_F(TestPostgres, TestTimestamp) {
     FAIL() << error.what();
   }
 }
+
+TEST_F(TestPostgres, TestPreparedInsert) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  const std::vector<uint8_t> blob = {0, 1, 2, 255};
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    for (int64_t index = 0; index < 10; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      // Quotes shall not need any escaping.
+      row.AppendAttribute(table, false, "TextValue", "O'Brien");
+      row.AppendAttribute(table, false, "BlobValue",
+                          OdsHelper::ToBase64(blob));
+      database.Insert(table, row, {});
+      EXPECT_EQ(row.ItemId(), index + 1);
+    }
+
+    // The second update uses the same prepared statement.
+    for (int64_t id = 1; id <= 2; ++id) {
+      IItem update(table.ApplicationId());
+      update.AppendAttribute(table, false, "TextValue", "Don't");
+      SqlFilter filter;
+      filter.AddWhere(*table.GetColumnByBaseName("id"), SqlCondition::Equal,
+                      id);
+      database.Update(table, update, filter);
+    }
+
+    // The filter values are bound, so the quote needs no escaping.
+    SqlFilter text_filter;
+    text_filter.AddWhere(*table.GetColumnByName("TextValue"),
+                         SqlCondition::Equal, std::string("O'Brien"));
+    text_filter.AddLimit(SqlCondition::LimitNofRows, 5);
+    ItemList text_list;
+    database.FetchItemList(table, text_list, text_filter);
+    EXPECT_EQ(text_list.size(), 5);
+
+    PostgresStatement select(database.Connection(),
+                             "SELECT * FROM test_a ORDER BY id");
+    int row = 0;
+    for (bool more = select.Step(); more ; more = select.Step()) {
+      EXPECT_EQ(select.Value<int64_t>("int_value"), row);
+      EXPECT_EQ(select.Value<std::string>("text_value"),
+                row < 2 ? "Don't" : "O'Brien");
+      EXPECT_EQ(select.Value<std::vector<uint8_t>>("blob_value"), blob);
+      ++row;
+    }
+    EXPECT_EQ(row, 10);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestParameters) {
+  PostgresParameters parameters;
+  parameters.AddInteger(258, PostgresType::Integer);
+  parameters.AddFloat(1.0);
+  parameters.AddBoolean(true);
+  parameters.AddBytes({0, 255});
+  parameters.AddText("O'Brien", PostgresType::Varchar);
+  parameters.AddNull(PostgresType::BigInt);
+  ASSERT_EQ(parameters.Size(), 6);
+
+  const auto* value_list = parameters.Values();
+  // Binary values are in network byte order.
+  EXPECT_EQ(parameters.Types()[0], 23);
+  EXPECT_EQ(parameters.Formats()[0], 1);
+  EXPECT_EQ(parameters.Lengths()[0], 4);
+  EXPECT_EQ(std::string(value_list[0], 4), std::string("\0\0\1\2", 4));
+
+  EXPECT_EQ(parameters.Type(1), PostgresType::Double);
+  EXPECT_EQ(parameters.Lengths()[1], 8);
+  EXPECT_EQ(static_cast<uint8_t>(value_list[1][0]), 0x3F);
+
+  EXPECT_EQ(parameters.Type(2), PostgresType::Boolean);
+  EXPECT_EQ(value_list[2][0], '\1');
+
+  EXPECT_EQ(parameters.Type(3), PostgresType::ByteArray);
+  EXPECT_EQ(parameters.Lengths()[3], 2);
+
+  EXPECT_EQ(parameters.Formats()[4], 0);
+  EXPECT_STREQ(value_list[4], "O'Brien");
+
+  EXPECT_TRUE(parameters.IsNull(5));
+  EXPECT_EQ(value_list[5], nullptr);
+  EXPECT_EQ(parameters.Type(5), PostgresType::BigInt);
+
+  parameters.Clear();
+  EXPECT_EQ(parameters.Size(), 0);
+}
+
+TEST_F(TestPostgres, TestCopyLine) {
+  PostgresParameters parameters;
+  parameters.AddInteger(-2, PostgresType::SmallInt);
+  parameters.AddInteger(258, PostgresType::BigInt);
+  parameters.AddFloat(0.5, PostgresType::Real);
+  parameters.AddBoolean(false);
+  parameters.AddBytes({0, 255});
+  parameters.AddText("a\tb\\c\n", PostgresType::Varchar);
+  parameters.AddNull(PostgresType::BigInt);
+
+  const auto line = PostgresCopy::MakeLine(parameters);
+  EXPECT_EQ(line, "-2\t258\t0.5\tf\t\\\\x00ff\ta\\tb\\\\c\\n\t\\N\n") << line;
+}
+
+TEST_F(TestPostgres, TestBulkLoad) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  constexpr size_t kNofRows = 100'000;
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  const std::vector<uint8_t> blob = {0, 1, 2, 255};
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    std::vector<IItem> row_list;
+    row_list.reserve(kNofRows);
+    for (size_t index = 0; index < kNofRows; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue",
+                          static_cast<int64_t>(index));
+      row.AppendAttribute(table, false, "TextValue", "Tab\tO'Brien\\");
+      row.AppendAttribute(table, false, "BlobValue",
+                          OdsHelper::ToBase64(blob));
+      row_list.push_back(row);
+    }
+    EXPECT_EQ(database.BulkLoad(table, row_list), kNofRows);
+
+    EXPECT_EQ(database.Count(table, {}), kNofRows);
+
+    PostgresStatement select(database.Connection(),
+                             "SELECT * FROM test_a ORDER BY id LIMIT 10");
+    int64_t row = 0;
+    for (bool more = select.Step(); more ; more = select.Step()) {
+      EXPECT_EQ(select.Value<int64_t>("int_value"), row);
+      EXPECT_EQ(select.Value<std::string>("text_value"), "Tab\tO'Brien\\");
+      EXPECT_EQ(select.Value<std::vector<uint8_t>>("blob_value"), blob);
+      ++row;
+    }
+    EXPECT_EQ(row, 10);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestCopyText) {
+  std::vector<std::string_view> value_list;
+  PostgresCopy::SplitLine("1\ta\\tb\t\\N\t", value_list);
+  ASSERT_EQ(value_list.size(), 4);
+  EXPECT_EQ(value_list[0], "1");
+  EXPECT_EQ(PostgresCopy::FromText(value_list[1]), "a\tb");
+  EXPECT_EQ(value_list[2], "\\N");
+  EXPECT_TRUE(value_list[3].empty());
+
+  std::string line;
+  PostgresCopy::AppendText("a\\b\r\n", line);
+  EXPECT_EQ(PostgresCopy::FromText(line), "a\\b\r\n");
+}
+
+TEST_F(TestPostgres, TestExportCsv) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < 10; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue", "Line\nTab\t");
+      row_list.push_back(row);
+    }
+    database.BulkLoad(table, row_list);
+
+    path csv_file(kTestDir);
+    csv_file.append("test_a.csv");
+    create_directories(csv_file.parent_path());
+    remove(csv_file);
+    database.ExportCsv(csv_file.string(), table, {});
+    EXPECT_TRUE(exists(csv_file));
+    EXPECT_GT(file_size(csv_file), 0);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestPipelineBatch) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint NOT NULL, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  constexpr int64_t kNofRows = 1'000;
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < kNofRows; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue", "Insert");
+      row_list.push_back(row);
+    }
+    const auto index_list = database.InsertBatch(table, row_list);
+    ASSERT_EQ(index_list.size(), row_list.size());
+    for (int64_t index = 0; index < kNofRows; ++index) {
+      EXPECT_EQ(index_list[index], index + 1);
+      EXPECT_EQ(row_list[index].ItemId(), index + 1);
+    }
+
+    std::vector<IItem> update_list;
+    for (const auto& row : row_list) {
+      IItem& update = update_list.emplace_back(table.ApplicationId());
+      update.ItemId(row.ItemId());
+      update.AppendAttribute(table, false, "TextValue", "Update");
+    }
+    database.UpdateBatch(table, update_list);
+
+    // A null value fails the NOT NULL constraint and no row shall be added.
+    row_list[10].SetAttribute({"IntValue", ""});
+    EXPECT_ANY_THROW(database.InsertBatch(table, row_list));
+    EXPECT_EQ(database.Count(table, {}), kNofRows);
+
+    PostgresStatement select(database.Connection(),
+                             "SELECT * FROM test_a ORDER BY id");
+    int64_t row = 0;
+    for (bool more = select.Step(); more ; more = select.Step()) {
+      EXPECT_EQ(select.Value<int64_t>("int_value"), row);
+      EXPECT_EQ(select.Value<std::string>("text_value"), "Update");
+      ++row;
+    }
+    EXPECT_EQ(row, kNofRows);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestBinaryResults) {
+  constexpr std::string_view kSelect = "SELECT 1::int2 AS a, -2::int4 AS b, "
+      "3::int8 AS c, 1.5::float8 AS d, 0.5::float4 AS e, true AS f, "
+      "'\\x00ff'::bytea AS g, 'Text' AS h, "
+      "'2000-01-01 00:00:01+00'::timestamptz AS i, NULL::int8 AS j";
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    for (const bool binary : {false, true}) {
+      PostgresStatement select(database.Connection(), kSelect.data(), binary);
+      ASSERT_TRUE(select.Step());
+      EXPECT_EQ(select.IsBinary(0), binary);
+      EXPECT_EQ(select.Value<int>("a"), 1);
+      EXPECT_EQ(select.Value<int64_t>("b"), -2);
+      EXPECT_EQ(select.Value<int64_t>("c"), 3);
+      EXPECT_DOUBLE_EQ(select.Value<double>("d"), 1.5);
+      EXPECT_FLOAT_EQ(select.Value<float>("e"), 0.5F);
+      EXPECT_EQ(select.Value<std::string>("f"), "t");
+      const std::vector<uint8_t> blob = {0, 255};
+      EXPECT_EQ(select.Value<std::vector<uint8_t>>("g"), blob);
+      EXPECT_EQ(select.Value<std::string>("g"), "\\x00ff");
+      EXPECT_EQ(select.Value<std::string>("h"), "Text");
+      EXPECT_EQ(select.Value<uint64_t>("i"), 946'684'801'000'000'000);
+      EXPECT_TRUE(select.IsNull(select.GetColumnIndex("j")));
+      EXPECT_FALSE(select.Step());
+    }
+
+    // Times that don't fit as nanoseconds since 1970 are clamped.
+    PostgresStatement limits(database.Connection(),
+        "SELECT 'infinity'::timestamp AS a, '-infinity'::timestamp AS b, "
+        "'3000-01-01'::timestamp AS c", true);
+    ASSERT_TRUE(limits.Step());
+    EXPECT_EQ(limits.Value<uint64_t>("a"),
+              std::numeric_limits<uint64_t>::max());
+    EXPECT_EQ(limits.Value<uint64_t>("b"), 0);
+    EXPECT_EQ(limits.Value<uint64_t>("c"),
+              std::numeric_limits<uint64_t>::max());
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestBinaryFetch) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  const std::vector<uint8_t> blob = {0, 1, 2, 255};
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    database.BinaryResults(true);
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < 10; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue", "Binary");
+      row.AppendAttribute(table, false, "BlobValue",
+                          OdsHelper::ToBase64(blob));
+      row_list.push_back(row);
+    }
+    database.InsertBatch(table, row_list);
+
+    ItemList item_list;
+    SqlFilter filter;
+    filter.AddOrder(*table.GetColumnByBaseName("id"));
+    database.FetchItemList(table, item_list, filter);
+    ASSERT_EQ(item_list.size(), 10);
+    int64_t index = 0;
+    for (const auto& item : item_list) {
+      EXPECT_EQ(item->ItemId(), index + 1);
+      EXPECT_EQ(item->Value<int64_t>("IntValue"), index);
+      EXPECT_EQ(item->Value<std::string>("TextValue"), "Binary");
+      EXPECT_EQ(item->Value<std::vector<uint8_t>>("BlobValue"), blob);
+      ++index;
+    }
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestChunkedFetch) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  constexpr int64_t kNofRows = 2'500;
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  try {
+    PostgresDb database;
+    database.ConnectionInfo(kConnectInfo.data());
+    DatabaseGuard guard(database);
+    EXPECT_TRUE(guard.IsOk());
+
+    database.ExecuteSql(kDropTable.data());
+    database.ExecuteSql(kCreateDb.data());
+
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < kNofRows; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue", "Chunk");
+      row_list.push_back(row);
+    }
+    database.BulkLoad(table, row_list);
+
+    {
+      PostgresStatement select(database.Connection(),
+                               "SELECT int_value FROM test_a ORDER BY id",
+                               false, 100);
+      int64_t row = 0;
+      for (bool more = select.Step(); more; more = select.Step()) {
+        EXPECT_EQ(select.Value<int64_t>(0), row);
+        ++row;
+      }
+      EXPECT_EQ(row, kNofRows);
+    }
+
+    SqlFilter filter;
+    filter.AddOrder(*table.GetColumnByBaseName("id"));
+    for (const size_t fetch_size : {size_t{0}, size_t{100}, size_t{2'500}}) {
+      database.FetchSize(fetch_size);
+      int64_t row = 0;
+      const auto count = database.FetchItems(table, filter,
+                                             [&] (IItem& item) {
+        EXPECT_EQ(item.Value<int64_t>("IntValue"), row);
+        EXPECT_EQ(item.Value<std::string>("TextValue"), "Chunk");
+        ++row;
+      });
+      EXPECT_EQ(count, kNofRows);
+      EXPECT_EQ(row, kNofRows);
+    }
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestConnectionPool) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  constexpr int64_t kNofRows = 100;
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  try {
+    PostgresConnectionPool pool(kConnectInfo.data(), 2);
+    {
+      auto connection = pool.Acquire();
+      ASSERT_TRUE(connection);
+      DatabaseGuard guard(*connection);
+      EXPECT_TRUE(guard.IsOk());
+      connection->ExecuteSql(kDropTable.data());
+      connection->ExecuteSql(kCreateDb.data());
+    }
+    EXPECT_EQ(pool.NofConnections(), 1);
+
+    {
+      auto connection1 = pool.Acquire();
+      auto connection2 = pool.Acquire();
+      ASSERT_TRUE(connection1);
+      ASSERT_TRUE(connection2);
+      EXPECT_EQ(pool.NofConnections(), 2);
+      EXPECT_FALSE(pool.Acquire(10ms));
+    }
+
+    // Two workers insert in parallel.
+    auto InsertRows = [&] () {
+      auto connection = pool.Acquire();
+      ASSERT_TRUE(connection);
+      DatabaseGuard guard(*connection);
+      for (int64_t index = 0; index < kNofRows; ++index) {
+        IItem row(table.ApplicationId());
+        row.AppendAttribute(table, false, "IntValue", index);
+        connection->Insert(table, row, {});
+      }
+    };
+    std::thread worker1(InsertRows);
+    std::thread worker2(InsertRows);
+    worker1.join();
+    worker2.join();
+    {
+      auto connection = pool.Acquire();
+      ASSERT_TRUE(connection);
+      DatabaseGuard guard(*connection);
+      EXPECT_EQ(connection->Count(table, {}), 2 * kNofRows);
+    }
+
+    // A broken connection shall be reconnected at the next check out.
+    pool.HealthCheckInterval(0ms);
+    {
+      auto connection = pool.Acquire();
+      ASSERT_TRUE(connection);
+      EXPECT_ANY_THROW(
+          connection->ExecuteSql("SELECT pg_terminate_backend(pg_backend_pid())"));
+    }
+    {
+      auto connection = pool.Acquire();
+      ASSERT_TRUE(connection);
+      EXPECT_TRUE(connection->IsConnectionOk());
+      DatabaseGuard guard(*connection);
+      EXPECT_EQ(connection->Count(table, {}), 2 * kNofRows);
+    }
+    pool.Close();
+    EXPECT_EQ(pool.NofConnections(), 0);
+
+    // A lease that outlives its pool closes the connection.
+    PostgresConnectionLease orphan;
+    {
+      PostgresConnectionPool temp_pool(kConnectInfo.data(), 1);
+      orphan = temp_pool.Acquire();
+      ASSERT_TRUE(orphan);
+    }
+    EXPECT_TRUE(orphan->IsConnectionOk());
+    orphan.Release();
+    EXPECT_FALSE(orphan);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestAsyncFetch) {
+  constexpr std::string_view kCreateDb = "CREATE TABLE IF NOT EXISTS test_a ("
+                                         "id bigserial PRIMARY KEY,"
+                                         "int_value bigint, "
+                                         "text_value varchar,"
+                                         "blob_value bytea)";
+  constexpr int64_t kNofRows = 1'000;
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  const auto table = MakeTestTable();
+  PostgresDb database;
+  database.ConnectionInfo(kConnectInfo.data());
+  try {
+    {
+      DatabaseGuard guard(database);
+      EXPECT_TRUE(guard.IsOk());
+      database.ExecuteSql(kDropTable.data());
+      database.ExecuteSql(kCreateDb.data());
+      std::vector<IItem> row_list;
+      for (int64_t index = 0; index < kNofRows; ++index) {
+        IItem row(table.ApplicationId());
+        row.AppendAttribute(table, false, "IntValue", index);
+        row.AppendAttribute(table, false, "TextValue",
+                            "Row " + std::to_string(index));
+        row_list.push_back(row);
+      }
+      database.InsertBatch(table, row_list);
+    }
+
+    // Several queries in flight at the same time.
+    SqlFilter filter;
+    filter.AddWhere(*table.GetColumnByName("IntValue"), SqlCondition::Less,
+                    static_cast<int64_t>(10));
+    auto future_all = database.FetchItemListAsync(table, {});
+    auto future_some = database.FetchItemListAsync(table, filter);
+
+    std::atomic<bool> done = false;
+    size_t nof_items = 0;
+    database.FetchItemListAsync(table, filter,
+        [&] (ItemList& item_list, const std::string& error) {
+      EXPECT_TRUE(error.empty()) << error;
+      nof_items = item_list.size();
+      done = true;
+    });
+
+    const auto all_list = future_all.get();
+    const auto some_list = future_some.get();
+    EXPECT_EQ(all_list.size(), kNofRows);
+    EXPECT_EQ(some_list.size(), 10);
+    for (const auto& item : some_list) {
+      EXPECT_LT(item->Value<int64_t>("IntValue"), 10);
+      EXPECT_FALSE(item->Value<std::string>("TextValue").empty());
+    }
+    for (size_t wait = 0; wait < 100 && !done; ++wait) {
+      std::this_thread::sleep_for(100ms);
+    }
+    EXPECT_TRUE(done);
+    EXPECT_EQ(nof_items, 10);
+
+    // A bad query returns an error through the future.
+    ods::ITable bad_table = table;
+    bad_table.DatabaseName("test_unknown");
+    auto future_bad = database.FetchItemListAsync(bad_table, {});
+    EXPECT_ANY_THROW(future_bad.get());
+
+    {
+      DatabaseGuard guard(database);
+      database.ExecuteSql(kDropTable.data());
+    }
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestPostgres, TestQueryTimeout) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  PostgresDb database;
+  database.ConnectionInfo(kConnectInfo.data());
+  database.Persistent(true);
+  try {
+    database.QueryTimeout(100ms);
+    ASSERT_TRUE(database.Open());
+    database.CommitTransaction();
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_ANY_THROW(database.ExecuteSql("SELECT pg_sleep(10)"));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    // Abort from another thread.
+    database.QueryTimeout(0ms);
+    std::thread cancel([&] {
+      std::this_thread::sleep_for(100ms);
+      database.Interrupt();
+    });
+    EXPECT_ANY_THROW(database.ExecuteSql("SELECT pg_sleep(10)"));
+    cancel.join();
+    EXPECT_EQ(database.ExecuteSql("SELECT 1"), 1);
+    database.Close(false);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
 } // namespace ods::test
\ No newline at end of file
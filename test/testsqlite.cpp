@@ -8,12 +8,17 @@
 #include <chrono>
 #include <numeric>
 #include <array>
+#include <sstream>
 #include "util/logconfig.h"
 #include "util/logstream.h"
 #include "util/timestamp.h"
 #include "sqlitedatabase.h"
 #include "sqlitestatement.h"
+#include "sqlitestatementcache.h"
+#include "sqliteconnectionpool.h"
 #include "ods/databaseguard.h"
+#include "ods/itable.h"
+#include "ods/iitem.h"
 #include "testsqlite.h"
 
 namespace {
@@ -33,6 +38,24 @@ constexpr std::string_view kInsertDb = "INSERT INTO test_a (int_value, float_val
                                        "VALUES(?1, ?2, ?3, ?4)";
 constexpr std::string_view kNewDb = "new_db.sqlite";
 constexpr std::string_view kWriteDb = "write_db.sqlite";
+constexpr std::string_view kCacheDb = "cache_db.sqlite";
+constexpr std::string_view kBatchDb = "batch_db.sqlite";
+constexpr std::string_view kFetchDb = "fetch_db.sqlite";
+constexpr std::string_view kProfileDb = "profile_db.sqlite";
+constexpr std::string_view kPersistentDb = "persistent_db.sqlite";
+constexpr std::string_view kPoolDb = "pool_db.sqlite";
+constexpr std::string_view kDecodeDb = "decode_db.sqlite";
+constexpr std::string_view kBlobDb = "blob_db.sqlite";
+constexpr std::string_view kBlobFile = "blob_file.bin";
+constexpr std::string_view kBackupDb = "backup_db.sqlite";
+constexpr std::string_view kBackupCopyDb = "backup_copy_db.sqlite";
+constexpr std::string_view kVacuumDb = "vacuum_db.sqlite";
+constexpr std::string_view kTimeoutDb = "timeout_db.sqlite";
+constexpr std::string_view kColumnDb = "column_db.sqlite";
+constexpr std::string_view kCreateBatchDb = "CREATE TABLE test_b ("
+                                            "id INTEGER PRIMARY KEY,"
+                                            "int_value INTEGER UNIQUE, "
+                                            "text_value TEXT)";
 
 constexpr std::array<int64_t,4> kIntList = {
     12,
@@ -63,6 +86,35 @@ const std::array<std::vector<uint8_t>, 4>  kBlobList = {
 };
 
 bool kSkipTest = false;
+
+ods::ITable MakeBatchTable() {
+  using namespace ods;
+  ITable table;
+  table.ApplicationId(1);
+  table.ApplicationName("TestB");
+  table.DatabaseName("test_b");
+
+  IColumn id_column;
+  id_column.ApplicationName("Id");
+  id_column.BaseName("id");
+  id_column.DatabaseName("id");
+  id_column.DataType(DataType::DtId);
+  table.AddColumn(id_column);
+
+  IColumn int_column;
+  int_column.ApplicationName("IntValue");
+  int_column.DatabaseName("int_value");
+  int_column.DataType(DataType::DtLongLong);
+  table.AddColumn(int_column);
+
+  IColumn text_column;
+  text_column.ApplicationName("TextValue");
+  text_column.DatabaseName("text_value");
+  text_column.DataType(DataType::DtString);
+  table.AddColumn(text_column);
+  return table;
+}
+
 }
 
 using namespace std::this_thread;
@@ -218,4 +270,748 @@ TEST_F(TestSqlite, WriteAndRead) {
   }
 }
 
+TEST_F(TestSqlite, StatementCache) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kCacheDb);
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateDb.data());
+
+    SqliteStatementCache cache(2);
+    auto insert = cache.Acquire(database.Sqlite3(), kInsertDb.data());
+    ASSERT_TRUE(insert);
+    const auto* first = insert.get();
+
+    // The statement is checked out, so a second acquire must prepare a new one.
+    auto busy = cache.Acquire(database.Sqlite3(), kInsertDb.data());
+    EXPECT_NE(busy.get(), first);
+    busy.reset();
+
+    for (size_t index = 0; index < 4; ++index) {
+      insert->SetValue(1, kIntList[index]);
+      insert->SetValue(2, kFloatList[index]);
+      insert->SetValue(3, kTextList[index].data());
+      insert->SetValue(4, kBlobList[index]);
+      insert->Step();
+      cache.Release(std::move(insert));
+      EXPECT_EQ(cache.Size(), 1);
+
+      insert = cache.Acquire(database.Sqlite3(), kInsertDb.data());
+      EXPECT_EQ(insert.get(), first);
+      EXPECT_EQ(cache.Size(), 0);
+    }
+    cache.Release(std::move(insert));
+
+    auto select = cache.Acquire(database.Sqlite3(), kSelectDb.data());
+    size_t rows = 0;
+    for (auto more = select->Step(); more; more = select->Step()) {
+      ++rows;
+    }
+    EXPECT_EQ(rows, 4);
+    cache.Release(std::move(select));
+    EXPECT_EQ(cache.Size(), 2);
+
+    auto count = cache.Acquire(database.Sqlite3(), "SELECT COUNT(*) FROM test_a");
+    const auto* count_statement = count.get();
+    cache.Release(std::move(count));
+    EXPECT_EQ(cache.Size(), 2); // Least used removed
+
+    // The insert statement was the least recently used, so it is prepared
+    // again while the count statement is still in the cache.
+    insert = cache.Acquire(database.Sqlite3(), kInsertDb.data());
+    EXPECT_EQ(cache.Size(), 2);
+    insert.reset();
+    count = cache.Acquire(database.Sqlite3(), "SELECT COUNT(*) FROM test_a");
+    EXPECT_EQ(count.get(), count_statement);
+    EXPECT_EQ(cache.Size(), 1);
+    count.reset();
+
+    cache.Clear();
+    EXPECT_EQ(cache.Size(), 0);
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, InsertBatch) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kBatchDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+
+    std::vector<IItem> row_list(1'000);
+    for (size_t index = 0; index < row_list.size(); ++index) {
+      auto& row = row_list[index];
+      row.ApplicationId(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(index));
+      row.AppendAttribute(table, false, "TextValue", std::to_string(index));
+    }
+    const auto index_list = database.InsertBatch(table, row_list);
+    ASSERT_EQ(index_list.size(), row_list.size());
+    for (size_t index = 0; index < index_list.size(); ++index) {
+      EXPECT_GT(index_list[index], 0);
+      EXPECT_EQ(index_list[index], row_list[index].ItemId());
+      if (index > 0) {
+        EXPECT_GT(index_list[index], index_list[index - 1]);
+      }
+    }
+    EXPECT_EQ(database.Count(table, {}), row_list.size());
+
+    // A duplicate shall roll back the entire batch.
+    std::vector<IItem> fail_list(2);
+    for (auto& row : fail_list) {
+      row.ApplicationId(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(-1));
+    }
+    EXPECT_ANY_THROW(database.InsertBatch(table, fail_list));
+    EXPECT_EQ(database.Count(table, {}), row_list.size());
+
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, FetchItems) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kFetchDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+
+    std::vector<IItem> row_list(100);
+    for (size_t index = 0; index < row_list.size(); ++index) {
+      auto& row = row_list[index];
+      row.ApplicationId(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(index));
+    }
+    database.InsertBatch(table, row_list);
+
+    ItemList item_list;
+    database.FetchItemList(table, item_list, {});
+    ASSERT_EQ(item_list.size(), row_list.size());
+    for (size_t index = 0; index < item_list.size(); ++index) {
+      const auto& item = item_list[index];
+      ASSERT_TRUE(item);
+      EXPECT_EQ(item->AttributeList().size(), 3);
+      EXPECT_EQ(item->ItemId(), row_list[index].ItemId());
+      EXPECT_EQ(item->Value<int64_t>("IntValue"), static_cast<int64_t>(index));
+    }
+
+    size_t count = 0;
+    const auto nof_items = database.FetchItems(table, {}, [&] (IItem& item) {
+      EXPECT_EQ(item.Value<int64_t>("IntValue"), static_cast<int64_t>(count));
+      ++count;
+    });
+    EXPECT_EQ(nof_items, row_list.size());
+    EXPECT_EQ(count, row_list.size());
+
+    // The filter values are bound, so the same statement is used again.
+    const auto* id_column = table.GetColumnByBaseName("id");
+    const auto* int_column = table.GetColumnByName("IntValue");
+    ASSERT_TRUE(id_column != nullptr && int_column != nullptr);
+    for (int64_t value : {10, 20}) {
+      SqlFilter filter;
+      filter.AddWhere(*int_column, SqlCondition::Equal, value);
+      ItemList filter_list;
+      database.FetchItemList(table, filter_list, filter);
+      ASSERT_EQ(filter_list.size(), 1);
+      EXPECT_EQ(filter_list[0]->Value<int64_t>("IntValue"), value);
+    }
+    SqlFilter limit_filter;
+    limit_filter.AddWhere(*int_column, SqlCondition::GreaterEQ, int64_t{50});
+    limit_filter.AddLimit(SqlCondition::LimitNofRows, 5);
+    ItemList limit_list;
+    database.FetchItemList(table, limit_list, limit_filter);
+    EXPECT_EQ(limit_list.size(), 5);
+
+    IItem update;
+    update.ApplicationId(table.ApplicationId());
+    update.AppendAttribute(table, false, "IntValue", int64_t{1000});
+    SqlFilter id_filter;
+    id_filter.AddWhere(*id_column, SqlCondition::Equal,
+                       row_list[3].ItemId());
+    database.Update(table, update, id_filter);
+    SqlFilter update_filter;
+    update_filter.AddWhere(*int_column, SqlCondition::Equal, int64_t{1000});
+    ItemList update_list;
+    database.FetchItemList(table, update_list, update_filter);
+    ASSERT_EQ(update_list.size(), 1);
+    EXPECT_EQ(update_list[0]->ItemId(), row_list[3].ItemId());
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, Profile) {
+  auto profile = SqliteProfile::Preset("read-mostly");
+  EXPECT_EQ(profile.JournalMode(), "WAL");
+  EXPECT_EQ(profile.Synchronous(), "NORMAL");
+  EXPECT_TRUE(profile.CacheSize().has_value());
+  EXPECT_TRUE(profile.MmapSize().has_value());
+  EXPECT_EQ(profile.TempStore(), "MEMORY");
+  EXPECT_FALSE(profile.IsDefault());
+
+  // Readers shall only get the connection settings.
+  const auto reader = profile.ReaderProfile();
+  EXPECT_TRUE(reader.JournalMode().empty());
+  EXPECT_TRUE(reader.Synchronous().empty());
+  EXPECT_TRUE(reader.AutoVacuum().empty());
+  EXPECT_EQ(reader.CacheSize(), profile.CacheSize());
+  EXPECT_EQ(reader.MakePragmaList().size(), 3);
+
+  EXPECT_TRUE(SqliteProfile::Preset("default").IsDefault());
+  EXPECT_TRUE(SqliteProfile::Preset("unknown").IsDefault());
+
+  SqliteProfile parse;
+  const auto filename = parse.ParseConnectionInfo(
+      "c:/temp/test.sqlite;profile=bulk-load;cache_size=-2000;journal_mode=wal");
+  EXPECT_EQ(filename, "c:/temp/test.sqlite");
+  EXPECT_EQ(parse.Name(), "bulk-load");
+  EXPECT_EQ(parse.Synchronous(), "OFF");
+  EXPECT_EQ(parse.CacheSize().value_or(0), -2000);
+  EXPECT_EQ(parse.JournalMode(), "WAL");
+  EXPECT_FALSE(parse.SetOption("synchronous", "FAST"));
+  EXPECT_FALSE(parse.SetOption("mmap_size", "-1"));
+  EXPECT_FALSE(parse.SetOption("unknown", "1"));
+  EXPECT_EQ(parse.MakePragmaList().size(), 4);
+
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kProfileDb);
+  file.make_preferred();
+  try {
+    SqliteDatabase database;
+    database.ConnectionInfo(file.string() + ";profile=wal");
+    EXPECT_EQ(database.FileName(), file.string());
+    EXPECT_EQ(database.Profile().JournalMode(), "WAL");
+
+    EXPECT_TRUE(database.OpenEx());
+    SqliteStatement journal(database.Sqlite3(), "PRAGMA journal_mode");
+    EXPECT_TRUE(journal.Step());
+    EXPECT_EQ(journal.Value<std::string>(0), "wal");
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, PersistentConnection) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kPersistentDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+    database.Close(true);
+
+    database.Persistent(true);
+    {
+      DatabaseGuard guard(database);
+      EXPECT_TRUE(guard.IsOk());
+      EXPECT_TRUE(database.InTransaction());
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(1));
+      database.Insert(table, row, {});
+    }
+    EXPECT_TRUE(database.IsOpen());
+    EXPECT_FALSE(database.InTransaction());
+
+    {
+      DatabaseGuard guard(database);
+      EXPECT_TRUE(guard.IsOk());
+      EXPECT_TRUE(database.InTransaction());
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(2));
+      database.Insert(table, row, {});
+      guard.Rollback();
+    }
+    EXPECT_TRUE(database.IsOpen());
+    EXPECT_FALSE(database.InTransaction());
+
+    {
+      DatabaseGuard guard(database);
+      EXPECT_EQ(database.Count(table, {}), 1);
+    }
+    EXPECT_TRUE(database.Close(true));
+    EXPECT_FALSE(database.IsOpen());
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, ConnectionPool) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kPoolDb);
+  const auto table = MakeBatchTable();
+  try {
+    {
+      SqliteDatabase database(file.string());
+      EXPECT_TRUE(database.OpenEx());
+      database.ExecuteSql(kCreateBatchDb.data());
+      database.Close(true);
+    }
+
+    SqliteConnectionPool pool(file.string(), 2);
+    auto writer = pool.AcquireWriter();
+    ASSERT_TRUE(writer);
+    EXPECT_TRUE(writer.IsWriter());
+    EXPECT_FALSE(pool.AcquireWriter(10ms));
+    {
+      DatabaseGuard guard(*writer);
+      EXPECT_TRUE(guard.IsOk());
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(1));
+      writer->Insert(table, row, {});
+
+      // The reader shall not be blocked by the write transaction.
+      auto reader = pool.AcquireReader();
+      ASSERT_TRUE(reader);
+      EXPECT_FALSE(reader.IsWriter());
+      EXPECT_TRUE(reader->Profile().JournalMode().empty());
+      EXPECT_EQ(reader->Count(table, {}), 0);
+    }
+    writer.Release();
+    EXPECT_FALSE(writer);
+
+    {
+      auto reader1 = pool.AcquireReader();
+      auto reader2 = pool.AcquireReader();
+      ASSERT_TRUE(reader1);
+      ASSERT_TRUE(reader2);
+      EXPECT_EQ(pool.NofReaders(), 2);
+      EXPECT_FALSE(pool.AcquireReader(10ms));
+      EXPECT_EQ(reader1->Count(table, {}), 1);
+      EXPECT_EQ(reader2->Count(table, {}), 1);
+    }
+
+    std::thread worker([&] {
+      auto reader = pool.AcquireReader();
+      EXPECT_TRUE(reader);
+    });
+    worker.join();
+    EXPECT_EQ(pool.NofReaders(), 2);
+    EXPECT_TRUE(pool.AcquireWriter());
+    pool.Close();
+    EXPECT_EQ(pool.NofReaders(), 0);
+
+    // A lease that outlives its pool closes the connection.
+    SqliteConnectionLease orphan;
+    {
+      SqliteConnectionPool temp_pool(file.string(), 1);
+      orphan = temp_pool.AcquireReader();
+      ASSERT_TRUE(orphan);
+    }
+    EXPECT_EQ(orphan->Count(table, {}), 1);
+    orphan.Release();
+    EXPECT_FALSE(orphan);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, DecodeValues) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kDecodeDb);
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    SqliteStatement select(database.Sqlite3(),
+        "SELECT ' 42', '+3.5', '7abc', 'abc', 'Text', x'0102', 11, 2.5, NULL");
+    ASSERT_TRUE(select.Step());
+    EXPECT_EQ(select.Value<int64_t>(0), 42);
+    EXPECT_DOUBLE_EQ(select.Value<double>(1), 3.5);
+    EXPECT_EQ(select.Value<int>(2), 7);
+    EXPECT_EQ(select.Value<int64_t>(3), 0);
+    EXPECT_EQ(select.Value<std::string>(4), "Text");
+
+    const std::vector<uint8_t> blob = {1, 2};
+    EXPECT_EQ(select.Value<std::vector<uint8_t>>(5), blob);
+    EXPECT_FALSE(select.Value<std::string>(5).empty());
+
+    EXPECT_EQ(select.Value<uint16_t>(6), 11);
+    EXPECT_EQ(select.Value<std::string>(6), "11");
+    EXPECT_FLOAT_EQ(select.Value<float>(7), 2.5F);
+    EXPECT_TRUE(select.IsNull(8));
+    EXPECT_EQ(select.Value<int64_t>(8), 0);
+    EXPECT_TRUE(select.Value<std::string>(8).empty());
+    EXPECT_FALSE(select.Step());
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, BlobStream) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kBlobDb);
+  std::filesystem::path blob_file(kTestDir);
+  blob_file.append(kBlobFile);
+
+  ITable table;
+  table.ApplicationId(1);
+  table.ApplicationName("TestC");
+  table.DatabaseName("test_c");
+  IColumn id_column;
+  id_column.ApplicationName("Id");
+  id_column.BaseName("id");
+  id_column.DatabaseName("id");
+  id_column.DataType(DataType::DtId);
+  table.AddColumn(id_column);
+  IColumn blob_column;
+  blob_column.ApplicationName("BlobValue");
+  blob_column.DatabaseName("blob_value");
+  blob_column.DataType(DataType::DtBlob);
+  table.AddColumn(blob_column);
+
+  std::vector<uint8_t> data(200'000);
+  for (size_t index = 0; index < data.size(); ++index) {
+    data[index] = static_cast<uint8_t>(index % 251);
+  }
+
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql("CREATE TABLE test_c (id INTEGER PRIMARY KEY, "
+                        "blob_value BLOB)");
+    database.ExecuteSql("INSERT INTO test_c (blob_value) VALUES (x'00')");
+
+    database.WriteBlob(table, "BlobValue", 1, data, 10'000);
+    EXPECT_EQ(database.BlobSize(table, "BlobValue", 1), data.size());
+
+    std::vector<uint8_t> dest;
+    database.ReadBlob(table, "BlobValue", 1, dest);
+    EXPECT_EQ(dest, data);
+
+    std::ostringstream stream;
+    EXPECT_EQ(database.ReadBlob(table, "BlobValue", 1, stream, 333),
+              data.size());
+    EXPECT_EQ(stream.str().size(), data.size());
+
+    EXPECT_EQ(database.ReadBlobToFile(table, "BlobValue", 1,
+                                      blob_file.string()), data.size());
+    database.ExecuteSql("INSERT INTO test_c (blob_value) VALUES (NULL)");
+    database.WriteBlobFromFile(table, "BlobValue", 2, blob_file.string());
+    database.ReadBlob(table, "BlobValue", 2, dest);
+    EXPECT_EQ(dest, data);
+
+    EXPECT_ANY_THROW(database.WriteBlob(table, "BlobValue", 3, data));
+    EXPECT_ANY_THROW(database.WriteBlob(table, "NoColumn", 1, data));
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, Backup) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kBackupDb);
+  std::filesystem::path copy_file(kTestDir);
+  copy_file.append(kBackupCopyDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < 1'000; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue", "Some text to fill pages");
+      row_list.push_back(row);
+    }
+    database.InsertBatch(table, row_list);
+    database.CommitTransaction();
+
+    // Online backup while the source is open.
+    size_t nof_steps = 0;
+    int last_remaining = -1;
+    database.Backup(copy_file.string(), 2, [&](int remaining, int page_count) {
+      EXPECT_GT(page_count, 0);
+      last_remaining = remaining;
+      ++nof_steps;
+    });
+    EXPECT_GT(nof_steps, 1);
+    EXPECT_EQ(last_remaining, 0);
+
+    SqliteDatabase memory(":memory:");
+    EXPECT_TRUE(memory.OpenEx());
+    database.Backup(memory);
+    EXPECT_EQ(memory.Count(table, {}), 1'000);
+    memory.Close(false);
+    database.Close(true);
+
+    // Backup of a closed database uses a temporary connection.
+    SqliteDatabase copy(copy_file.string());
+    EXPECT_TRUE(copy.OpenEx());
+    EXPECT_EQ(copy.Count(table, {}), 1'000);
+    copy.Close(false);
+
+    SqliteDatabase memory2(":memory:");
+    EXPECT_TRUE(memory2.OpenEx());
+    database.Backup(memory2, -1);
+    EXPECT_FALSE(database.IsOpen());
+    EXPECT_EQ(memory2.Count(table, {}), 1'000);
+    memory2.Close(false);
+
+    // A writer that changes the source between each step restarts the
+    // backup. The backup shall still finish.
+    SqliteDatabase writer(file.string());
+    EXPECT_TRUE(writer.OpenEx());
+    writer.CommitTransaction();
+    SqliteDatabase memory3(":memory:");
+    EXPECT_TRUE(memory3.OpenEx());
+    size_t nof_writes = 0;
+    database.Backup(memory3, 2, [&](int remaining, int) {
+      if (remaining > 0 && nof_writes < 100) {
+        writer.ExecuteSql("INSERT INTO test_b (int_value) VALUES (" +
+                          std::to_string(2'000 + nof_writes) + ")");
+        ++nof_writes;
+      }
+    });
+    EXPECT_GT(nof_writes, 0);
+    EXPECT_LT(nof_writes, 100); // The restarts are bounded
+    EXPECT_GE(memory3.Count(table, {}), 1'000);
+    memory3.Close(false);
+    writer.Close(false);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, IncrementalVacuum) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kVacuumDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    EXPECT_EQ(database.AutoVacuum(), 0);
+    database.ExecuteSql(kCreateBatchDb.data());
+    std::vector<IItem> row_list;
+    for (int64_t index = 0; index < 2'000; ++index) {
+      IItem row(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", index);
+      row.AppendAttribute(table, false, "TextValue",
+                          std::string(100, 'A'));
+      row_list.push_back(row);
+    }
+    database.InsertBatch(table, row_list);
+    database.Close(true);
+
+    // Convert the existing database to incremental vacuum.
+    auto profile = SqliteProfile::Preset("wal");
+    profile.AutoVacuum("incremental");
+    EXPECT_EQ(profile.AutoVacuum(), "INCREMENTAL");
+    database.Profile(profile);
+    database.Vacuum();
+
+    EXPECT_TRUE(database.OpenEx());
+    EXPECT_EQ(database.AutoVacuum(), 2);
+    database.ExecuteSql("DELETE FROM test_b WHERE int_value >= 100");
+    database.CommitTransaction();
+    const auto free_pages = database.FreePages();
+    EXPECT_GT(free_pages, 10);
+
+    database.IncrementalVacuum(10);
+    EXPECT_EQ(database.FreePages(), free_pages - 10);
+    database.IncrementalVacuum(free_pages);
+    EXPECT_EQ(database.FreePages(), 0);
+    EXPECT_EQ(database.Count(table, {}), 100);
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, QueryTimeout) {
+  // Counts forever unless the query is aborted.
+  constexpr std::string_view kEndlessSql =
+      "WITH RECURSIVE counter(x) AS (SELECT 1 UNION ALL "
+      "SELECT x + 1 FROM counter) SELECT count(*) FROM counter";
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kTimeoutDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+    EXPECT_EQ(database.QueryTimeout().count(), 0);
+
+    database.QueryTimeout(100ms);
+    EXPECT_EQ(database.QueryTimeout(), 100ms);
+    const auto start = std::chrono::steady_clock::now();
+    EXPECT_ANY_THROW(database.ExecuteSql(kEndlessSql.data()));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 10s);
+    EXPECT_EQ(database.Count(table, {}), 0);
+
+    // Abort from another thread.
+    database.QueryTimeout(0ms);
+    std::thread cancel([&] {
+      sleep_for(100ms);
+      database.Interrupt();
+    });
+    EXPECT_ANY_THROW(database.ExecuteSql(kEndlessSql.data()));
+    cancel.join();
+    EXPECT_EQ(database.Count(table, {}), 0);
+
+    // Writes shall not run under the deadline of an earlier query.
+    std::vector<IItem> row_list(5'000);
+    for (size_t index = 0; index < row_list.size(); ++index) {
+      auto& row = row_list[index];
+      row.ApplicationId(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(index));
+      row.AppendAttribute(table, false, "TextValue", std::to_string(index));
+    }
+    database.InsertBatch(table, row_list);
+    database.QueryTimeout(100ms);
+    EXPECT_EQ(database.Count(table, {}), row_list.size());
+    sleep_for(200ms);
+
+    // An interrupt that arrives before a statement starts is not lost, but
+    // transaction control statements are never interrupted.
+    database.ExecuteSql("SAVEPOINT interrupt_test");
+    database.Interrupt();
+    EXPECT_NO_THROW(database.ExecuteSql("RELEASE SAVEPOINT interrupt_test"));
+    EXPECT_ANY_THROW(database.ExecuteSql(kEndlessSql.data()));
+
+    IItem update;
+    update.ApplicationId(table.ApplicationId());
+    update.AppendAttribute(table, false, "TextValue", std::string("Updated"));
+    const auto* int_column = table.GetColumnByName("IntValue");
+    ASSERT_TRUE(int_column != nullptr);
+    SqlFilter filter;
+    filter.AddWhere(*int_column, SqlCondition::GreaterEQ, int64_t{0});
+    EXPECT_NO_THROW(database.Update(table, update, filter));
+    database.QueryTimeout(0ms);
+    EXPECT_EQ(database.ExecuteSql("SELECT COUNT(*) FROM test_b "
+                                  "WHERE text_value LIKE '%Updated%'"),
+              row_list.size());
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
+TEST_F(TestSqlite, FetchColumns) {
+  if (kSkipTest) {
+    GTEST_SKIP();
+  }
+
+  std::filesystem::path file(kTestDir);
+  file.append(kColumnDb);
+  const auto table = MakeBatchTable();
+  try {
+    SqliteDatabase database(file.string());
+    EXPECT_TRUE(database.OpenEx());
+    database.ExecuteSql(kCreateBatchDb.data());
+
+    std::vector<IItem> row_list(100);
+    for (size_t index = 0; index < row_list.size(); ++index) {
+      auto& row = row_list[index];
+      row.ApplicationId(table.ApplicationId());
+      row.AppendAttribute(table, false, "IntValue", static_cast<int64_t>(index));
+      row.AppendAttribute(table, false, "TextValue", std::to_string(index));
+    }
+    database.InsertBatch(table, row_list);
+    database.ExecuteSql("INSERT INTO test_b (int_value) VALUES (1000)");
+    const size_t nof_rows = row_list.size() + 1;
+
+    const auto data_list = database.FetchColumns(table, {},
+                                                 {"TextValue", "IntValue"});
+    ASSERT_EQ(data_list.size(), 2);
+    const auto& text_data = data_list[0];
+    const auto& int_data = data_list[1];
+    EXPECT_EQ(text_data.Name(), "TextValue");
+    EXPECT_EQ(text_data.Storage(), ColumnStorage::Text);
+    EXPECT_EQ(int_data.Storage(), ColumnStorage::Integer);
+    ASSERT_EQ(text_data.Size(), nof_rows);
+    ASSERT_EQ(int_data.Size(), nof_rows);
+    ASSERT_EQ(int_data.Integers().size(), nof_rows);
+    for (size_t index = 0; index < row_list.size(); ++index) {
+      EXPECT_FALSE(int_data.IsNull(index));
+      EXPECT_FALSE(text_data.IsNull(index));
+      EXPECT_EQ(int_data.Integers()[index], static_cast<int64_t>(index));
+      // The insert stores the text as an SQL quoted string.
+      EXPECT_EQ(text_data.Text(index), "'" + std::to_string(index) + "'");
+    }
+    EXPECT_EQ(int_data.Integers().back(), 1000);
+    EXPECT_TRUE(text_data.IsNull(row_list.size()));
+    EXPECT_TRUE(text_data.Text(row_list.size()).empty());
+    EXPECT_EQ(text_data.NofNulls(), 1);
+    EXPECT_EQ(int_data.NofNulls(), 0);
+
+    // The generic function shall give the same values.
+    const auto item_list = database.IDatabase::FetchColumns(table, {},
+        {"TextValue", "IntValue"});
+    ASSERT_EQ(item_list.size(), 2);
+    ASSERT_EQ(item_list[1].Size(), nof_rows);
+    EXPECT_EQ(item_list[1].Integers(), int_data.Integers());
+    for (size_t index = 0; index < nof_rows; ++index) {
+      EXPECT_EQ(item_list[0].Text(index), text_data.Text(index));
+    }
+
+    const auto all_list = database.FetchColumns(table, {}, {});
+    ASSERT_EQ(all_list.size(), table.Columns().size());
+    EXPECT_EQ(all_list[0].Size(), nof_rows);
+
+    EXPECT_ANY_THROW(const auto unknown = database.FetchColumns(table, {},
+        {"Unknown"}));
+    database.Close(true);
+  } catch (const std::exception& error) {
+    FAIL() << error.what();
+  }
+}
+
 }